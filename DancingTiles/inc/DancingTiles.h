@@ -0,0 +1,99 @@
+/**
+    DancingTiles.h
+
+    Description:
+    The DancingTiles effect as a self contained instance. All the state that used to live in file statics
+    (light sources, frequency bin history, layout derived data, render buffers) hangs off a dancing_tiles_t,
+    and the instance never calls into the host: the sound features of a frame are handed in through a
+    frame_uniforms_t. AuroraPlugin.cpp is a thin shim that keeps one instance behind the
+    initPlugin/getPluginFrame/pluginCleanup ABI, while the simulator and benchmarks can create as many
+    instances as they like and run them on different threads.
+ */
+
+#ifndef INC_DANCINGTILES_H_
+#define INC_DANCINGTILES_H_
+
+#include <stdint.h>
+#include "AuroraPlugin.h"
+#include "ColorUtils.h"
+#include "LayoutProcessingUtils.h"
+
+// Everything a frame needs from the host, sampled once at the start of the frame, together with the values
+// derived from it. dancingTilesFrame() and the render kernels only read this block.
+typedef struct {
+    // sampled from the host
+    const uint8_t* fftBins;     // dancingTilesFftBins() bins
+    float tempo;                // beats per minute, 0 while the host has none
+    // derived by dancingTilesDeriveUniforms()
+    float multiplier;           // falloff multiplier of the sources, grows with the tempo when TEMPO_ENABLED
+} frame_uniforms_t;
+
+// What beats do to the panels
+typedef enum {
+    DANCING_TILES_SOURCES,      // spawn light sources whose colours every panel mixes with a falloff
+    DANCING_TILES_DIFFUSION,    // inject colour that diffuses over the panels, see DiffusionField.h
+    DANCING_TILES_RIPPLES,      // launch ripples that travel outward over the panels, see RippleField.h
+} dancing_tiles_mode_t;
+
+typedef struct {
+    int renderThreads;          // extra worker threads used to render the panels, 0 renders on the calling thread
+    int parallelMinPanels;      // below this many panels the worker threads are not used
+    const char* layoutCachePath; // file the layout derived data is kept in between loads, NULL disables it
+    float frameBudgetMs;        // the quality is stepped down while rendered frames cost more than this, 0 disables it
+    uint64_t randomSeed;        // seeds the instance's random numbers, the same seed replays the same run
+    dancing_tiles_mode_t mode;  // what beats do to the panels
+    bool rippleHops;            // DANCING_TILES_RIPPLES evaluates the ripples from the hop distance table rather than
+                                // stepping the wave equation, see RippleField.h
+} dancing_tiles_config_t;
+
+struct dancing_tiles_t;
+
+/**
+ * @description: fill in the configuration the plugin is built with
+ */
+void dancingTilesDefaultConfig(dancing_tiles_config_t* config);
+
+/**
+ * @description: create an instance for a layout and palette. Both have to outlive the instance.
+ * @param config: NULL for the defaults
+ */
+dancing_tiles_t* dancingTilesCreate(LayoutData* layoutData, RGB_t* palette, int nColors, const dancing_tiles_config_t* config);
+
+/**
+ * @description: number of fft bins the instance wants in frame_uniforms_t::fftBins
+ */
+int dancingTilesFftBins(const dancing_tiles_t* instance);
+
+/**
+ * @description: fill in the derived fields of a block whose host features were just sampled. A tempo of 0 is
+ * replaced by the last tempo the host reported.
+ */
+void dancingTilesDeriveUniforms(dancing_tiles_t* instance, frame_uniforms_t* uniforms);
+
+/**
+ * @description: advance the instance by one frame
+ * @param uniforms: the sampled sound features with the derived fields filled in by dancingTilesDeriveUniforms()
+ * @param frames: buffer with room for one frame per panel, only the panels that changed colour are written
+ * @param nFrames: filled with the number of frames written, 0 when nothing changed
+ */
+void dancingTilesFrame(dancing_tiles_t* instance, const frame_uniforms_t* uniforms, Frame_t* frames, int* nFrames);
+
+/**
+ * @description: seed the beat detector from a state saved by dancingTilesSaveDetector(), skipping the
+ * calibration. Call it right after dancingTilesCreate(). A NULL path is ignored.
+ * @return: true if the state was recent enough and saved for the same number of fft bins
+ */
+bool dancingTilesRestoreDetector(dancing_tiles_t* instance, const char* path);
+
+/**
+ * @description: save what the beat detector has learnt so the next instance can start from it. Nothing is
+ * written before the detector has been calibrated or when path is NULL.
+ */
+void dancingTilesSaveDetector(const dancing_tiles_t* instance, const char* path);
+
+/**
+ * @description: free the instance and everything it allocated. NULL is ignored.
+ */
+void dancingTilesDestroy(dancing_tiles_t* instance);
+
+#endif /* INC_DANCINGTILES_H_ */
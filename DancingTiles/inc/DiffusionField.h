@@ -0,0 +1,62 @@
+/**
+    DiffusionField.h
+
+    Description:
+    A colour field on the panels that spreads over the adjacency graph instead of being summed from every
+    light source. Each step is an explicit step of the graph Laplacian: a panel keeps part of its colour and
+    takes in a share of each neighbour's, with the same share flowing either way across an edge so colour
+    is only moved around, and then the whole field fades a little. Beats inject colour at a panel.
+
+    The neighbours come as a CSR list (see LayoutCache.h), so a step is one sparse matrix-vector product
+    and costs O(edges) however many beats have fired. R, G and B are kept side by side in one four lane
+    vector per panel so a neighbour is added in with a single SIMD add.
+ */
+
+#ifndef INC_DIFFUSIONFIELD_H_
+#define INC_DIFFUSIONFIELD_H_
+
+#include <stdint.h>
+
+// R, G, B and a lane that is always 0. Only 4 byte aligned so new[] on 32 bit targets is enough for it.
+typedef float diffusion_colour_t __attribute__((vector_size(16), aligned(4)));
+
+typedef struct {
+    int nPanels;
+    const int* adjacencyStart;      // the neighbours of panel p are adjacency[adjacencyStart[p]] up to adjacency[adjacencyStart[p + 1]]
+    const int* adjacency;
+    diffusion_colour_t* colours;    // the colour of each panel
+    diffusion_colour_t* next;       // the next step is built here and then swapped with colours
+    float* keep;                    // the share of its own colour a panel keeps, fade included
+    float take;                     // the share of each neighbour's colour a panel takes in, fade included
+} diffusion_field_t;
+
+/**
+ * @description: start with every panel dark. The adjacency lists have to outlive the field.
+ * @param rate: share of the colour difference that flows across an edge per step, lowered where it
+ *              would make the step unstable on the panel with the most neighbours
+ * @param fade: the field is multiplied by this after every step, below 1 so injected colour dies away
+ */
+void diffusionInit(diffusion_field_t* field, int nPanels, const int* adjacencyStart, const int* adjacency, float rate, float fade);
+
+/**
+ * @description: add colour to a panel
+ */
+void diffusionInject(diffusion_field_t* field, int panel, float R, float G, float B);
+
+/**
+ * @description: compute the next step of the panels [begin, end) into field->next. Calls with disjoint
+ * ranges can run concurrently; once every panel is done, diffusionSwap() makes the step current.
+ */
+void diffusionStepRange(diffusion_field_t* field, int begin, int end);
+
+/**
+ * @description: make the step computed by diffusionStepRange() the current colours
+ */
+void diffusionSwap(diffusion_field_t* field);
+
+/**
+ * @description: free the field
+ */
+void diffusionFree(diffusion_field_t* field);
+
+#endif /* INC_DIFFUSIONFIELD_H_ */
@@ -0,0 +1,145 @@
+/**
+    LayoutCache.h
+
+    Description:
+    Everything the plugin derives from the layout (a flat view of the panels, panel adjacency, the influence
+    lists used by the renderer, a uniform grid spatial index and, when asked for, the hop distance between
+    every pair of panels) is built once in initPlugin into a single arena allocation.
+    Arrays inside the arena refer to each other through indices and byte offsets only, so the arena can
+    be written to disk as is. On the next load of the same layout the file is mapped read-only and used
+    in place instead of being rebuilt. Either way it is released with one call from pluginCleanup.
+
+    The cache file is keyed on a hash of the panel ids, centroids and orientations plus the parameters it
+    was built with, and carries a format version. When the layout changes the file is rebuilt into a
+    temporary file and renamed over the old one, so a reader never sees a half written cache.
+
+    The hop distances, the fewest steps between adjacent panels that lead from one panel to another, come from a
+    breadth first search from every panel, run on all cores for large layouts. That is the bulk of the build, so
+    the table is only made for the effects that ask for it. They are symmetric and fit a byte,
+    so only the lower triangle is kept, cut into LAYOUT_CACHE_HOP_TILE square tiles stored one after the other
+    row by row. 2000 panels take 2 MB instead of the 16 MB of a full int matrix, and the distances between
+    panels with nearby indices share a few cache lines.
+ */
+
+#ifndef INC_LAYOUTCACHE_H_
+#define INC_LAYOUTCACHE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "LayoutProcessingUtils.h"
+
+#define LAYOUT_CACHE_MAGIC 0x4E4C4331 // "NLC1"
+#define LAYOUT_CACHE_VERSION 5 // bump whenever the arena format or the way it is built changes
+#define LAYOUT_CACHE_HOP_TILE 16 // panels per side of a tile of the hop distance table
+#define LAYOUT_CACHE_HOPS_MAX 254 // hop distances are capped at this
+#define LAYOUT_CACHE_HOPS_UNREACHABLE 255 // the hop distance between panels in separate pieces of the layout
+
+// An entry of a panel's influence list: a panel close enough to be reached by a source sitting on it.
+// d2 is the squared distance between the two panels in units of the adjacent panel distance.
+typedef struct {
+    int panel;
+    float d2;
+} influence_t;
+
+// The arena starts with this header, every array is stored as a byte offset from the start of the arena.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t layoutHash;        // hash of the layout and of the parameters the arena was built with
+    uint32_t size;              // size of the whole arena in bytes
+    int32_t nPanels;
+    int32_t gridWidth;          // spatial index: gridWidth x gridHeight square cells of gridCellSize
+    int32_t gridHeight;
+    float gridOriginX;          // lower left corner of cell 0
+    float gridOriginY;
+    float gridCellSize;
+    uint32_t panelIdsOffset;
+    uint32_t xOffset;
+    uint32_t yOffset;
+    uint32_t orientationOffset;
+    uint32_t shapeTypeOffset;
+    uint32_t adjacencyStartOffset;
+    uint32_t adjacencyOffset;
+    uint32_t influenceStartOffset;
+    uint32_t influenceOffset;
+    uint32_t gridStartOffset;
+    uint32_t gridPanelsOffset;
+    uint32_t hopsOffset;
+    uint32_t hopsSize;          // 0 when the arena was built without the hop distance table
+} layout_cache_header_t;
+
+// The panels of the layout as contiguous arrays, in the same order as LayoutData. Per frame code reads this
+// rather than chasing Panel -> Shape -> Point for every centroid.
+typedef struct {
+    int nPanels;
+    const int32_t* panelIds;
+    const float* x;                 // centroid of each panel
+    const float* y;
+    const int32_t* orientation;     // in degrees, see Shape::getOrientation()
+    const int32_t* shapeType;       // SHAPE_TRIANGLE, SHAPE_RHYTHM or SHAPE_SQUARE
+} layout_view_t;
+
+typedef struct {
+    const layout_cache_header_t* header;  // the start of the arena
+    layout_view_t view;
+    const int* adjacencyStart;      // the neighbours of panel p are adjacency[adjacencyStart[p]] up to adjacency[adjacencyStart[p + 1]]
+    const int* adjacency;
+    const int* influenceStart;      // same layout for the influence lists, each list is sorted by panel index
+    const influence_t* influence;
+    const int* gridStart;           // the panels in grid cell c are gridPanels[gridStart[c]] up to gridPanels[gridStart[c + 1]]
+    const int* gridPanels;
+    const uint8_t* hops;            // the hop distance table, read it with layoutCacheHops(). NULL unless it was asked for
+    bool mapped;                    // the arena is a read-only mapping of the cache file rather than a heap block
+} layout_cache_t;
+
+/**
+ * @description: build the layout derived data, or map it from cachePath if that file was written for
+ * the same layout and parameters. If it was not, the file is rebuilt.
+ * @param adjacentDistance: distance between the centroids of two panels that share an edge
+ * @param influenceRadius: panels up to this many adjacentDistances away end up on each other's influence list
+ * @param hopDistances: also build the hop distance table read by layoutCacheHops()
+ * @param cachePath: file to map the arena from and write it to, NULL to always build it in memory
+ * @return: the cache, free it with layoutCacheDestroy(). This never returns NULL, running out of memory
+ * throws std::bad_alloc like new does.
+ */
+layout_cache_t* layoutCacheCreate(LayoutData* layoutData, float adjacentDistance, float influenceRadius, bool hopDistances,
+                                  const char* cachePath);
+
+/**
+ * @description: release or unmap the arena and free the cache object. NULL is ignored.
+ */
+void layoutCacheDestroy(layout_cache_t* cache);
+
+/**
+ * @description: look up the spatial index cell containing a point
+ * @return: the cell index, -1 if the point lies outside the grid
+ */
+int layoutCacheGridCell(const layout_cache_t* cache, float x, float y);
+
+/**
+ * @description: where the hop distance between panels p and q is kept in the table, p must be at least q
+ */
+static inline size_t layoutCacheHopIndex(int p, int q)
+{
+    size_t tileRow = p / LAYOUT_CACHE_HOP_TILE;
+    size_t tile = tileRow * (tileRow + 1) / 2 + q / LAYOUT_CACHE_HOP_TILE;
+    return (tile * LAYOUT_CACHE_HOP_TILE + p % LAYOUT_CACHE_HOP_TILE) * LAYOUT_CACHE_HOP_TILE + q % LAYOUT_CACHE_HOP_TILE;
+}
+
+/**
+ * @description: the number of steps between adjacent panels it takes to get from panel p to panel q. Only for
+ * a cache created with hopDistances.
+ * @return: 0 for the panel itself, at most LAYOUT_CACHE_HOPS_MAX, or LAYOUT_CACHE_HOPS_UNREACHABLE
+ */
+static inline int layoutCacheHops(const layout_cache_t* cache, int p, int q)
+{
+    return p >= q ? cache->hops[layoutCacheHopIndex(p, q)] : cache->hops[layoutCacheHopIndex(q, p)];
+}
+
+/**
+ * @description: the hop distances from panel p to every panel, see layoutCacheHops()
+ * @param hops: receives one distance per panel
+ */
+void layoutCacheHopsFrom(const layout_cache_t* cache, int p, uint8_t* hops);
+
+#endif /* INC_LAYOUTCACHE_H_ */
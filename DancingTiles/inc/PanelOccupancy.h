@@ -0,0 +1,61 @@
+/**
+    PanelOccupancy.h
+
+    Description:
+    Keeps track of which panels have something spawned on them, so a new source can be put on a free panel
+    without drawing random panels until one happens to be free. A bitmap answers "is this panel taken" and a
+    dense list holds the free panels, with the position of every panel in that list so a panel can be taken
+    by swapping the last free panel into its slot. Taking, releasing and drawing a random free panel are all
+    O(1) however full the layout is.
+ */
+
+#ifndef INC_PANELOCCUPANCY_H_
+#define INC_PANELOCCUPANCY_H_
+
+#include <stdint.h>
+#include "Prng.h"
+
+typedef struct {
+    int nPanels;
+    uint64_t* taken;            // bit p % 64 of word p / 64 is set while panel p is taken
+    int* freePanels;            // the first nFree entries are the free panels, in no particular order
+    int* freeSlot;              // position of each free panel in freePanels
+    int nFree;
+} panel_occupancy_t;
+
+/**
+ * @description: start with every panel free
+ */
+void occupancyInit(panel_occupancy_t* occupancy, int nPanels);
+
+/**
+ * @description: mark a panel taken, taking a taken panel does nothing
+ */
+void occupancyTake(panel_occupancy_t* occupancy, int panel);
+
+/**
+ * @description: mark a panel free again, releasing a free panel does nothing
+ */
+void occupancyRelease(panel_occupancy_t* occupancy, int panel);
+
+/**
+ * @description: true while the panel is taken
+ */
+static inline bool occupancyIsTaken(const panel_occupancy_t* occupancy, int panel)
+{
+    return (occupancy->taken[panel >> 6] >> (panel & 63)) & 1;
+}
+
+/**
+ * @description: pick a free panel, each one equally likely
+ * @param prng: the generator to draw from
+ * @return: the panel, -1 if every panel is taken
+ */
+int occupancyRandomFree(const panel_occupancy_t* occupancy, prng_t* prng);
+
+/**
+ * @description: free the bitmap and the lists
+ */
+void occupancyFree(panel_occupancy_t* occupancy);
+
+#endif /* INC_PANELOCCUPANCY_H_ */
@@ -0,0 +1,52 @@
+/**
+    QualityGovernor.h
+
+    Description:
+    Keeps the cost of a frame within a budget. The caller times every frame it renders with governorNow(),
+    a monotonic clock, and reports the cost with governorUpdate(). When a smoothed frame cost stays over the
+    budget the governor steps the quality down one level, and when it stays well under the budget for a
+    while it steps back up. The levels are cumulative: at QUALITY_CHEAP_KERNEL the sources are capped and
+    the radius is tightened as well.
+ */
+
+#ifndef INC_QUALITYGOVERNOR_H_
+#define INC_QUALITYGOVERNOR_H_
+
+#include <stdint.h>
+
+typedef enum {
+    QUALITY_FULL = 0,
+    QUALITY_CAP_SOURCES,        // fewer live sources, the oldest are dropped sooner
+    QUALITY_TIGHT_RADIUS,       // sources only reach the panels closest to them
+    QUALITY_CHEAP_KERNEL,       // a linear falloff instead of 1 / (d^2 * multiplier + 1)
+    QUALITY_SKIP_FRAMES,        // render every other frame, changes wait for the next rendered one
+    QUALITY_LEVELS
+} quality_level_t;
+
+typedef struct {
+    uint64_t budgetNs;          // 0 disables the governor
+    uint64_t averageNs;         // smoothed cost of the recent frames
+    int level;                  // a quality_level_t
+    int overBudget;             // consecutive frames the average was over the budget
+    int underBudget;            // consecutive frames the average was under the step up threshold
+} quality_governor_t;
+
+/**
+ * @description: start at full quality
+ * @param budgetMs: frame time budget, 0 keeps the quality at QUALITY_FULL
+ */
+void governorInit(quality_governor_t* governor, float budgetMs);
+
+/**
+ * @description: read the monotonic clock
+ * @return: nanoseconds since an arbitrary point
+ */
+uint64_t governorNow();
+
+/**
+ * @description: account for the cost of a rendered frame and step the quality up or down if needed
+ * @return: true if the level changed
+ */
+bool governorUpdate(quality_governor_t* governor, uint64_t frameNs);
+
+#endif /* INC_QUALITYGOVERNOR_H_ */
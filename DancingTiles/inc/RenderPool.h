@@ -0,0 +1,43 @@
+/**
+    RenderPool.h
+
+    Description:
+    A small persistent pool of worker threads used to split the per-panel render loop of
+    getPluginFrame() across cores. The threads are started once and parked on a condition
+    variable between frames, every call to renderPoolRun() acts as a barrier: it returns
+    only after every worker has finished its share of the panels. Nothing is allocated
+    after renderPoolCreate().
+ */
+
+#ifndef INC_RENDERPOOL_H_
+#define INC_RENDERPOOL_H_
+
+/**
+ * @description: callback that renders the items [begin, end). Called concurrently from
+ * several threads with disjoint ranges, so it must only write to its own items.
+ */
+typedef void (*render_range_fn)(int begin, int end, void* arg);
+
+struct render_pool_t;
+
+/**
+ * @description: start a pool with nWorkers extra threads. The calling thread always takes a share
+ * of the work as well, so nWorkers = 3 renders on 4 cores.
+ * @param minItems: below this many items renderPoolRun() renders on the calling thread only,
+ *        since waking the workers costs more than it saves.
+ * @return: the pool, or NULL if nWorkers < 1 (renderPoolRun() accepts a NULL pool)
+ */
+render_pool_t* renderPoolCreate(int nWorkers, int minItems);
+
+/**
+ * @description: render nItems items by calling fn on contiguous ranges from all threads of
+ * the pool, returns once all ranges are done.
+ */
+void renderPoolRun(render_pool_t* pool, render_range_fn fn, void* arg, int nItems);
+
+/**
+ * @description: stop and join the worker threads and free the pool. NULL is ignored.
+ */
+void renderPoolDestroy(render_pool_t* pool);
+
+#endif /* INC_RENDERPOOL_H_ */
@@ -0,0 +1,126 @@
+/**
+    RippleField.h
+
+    Description:
+    Ripples travelling over the panels, as a damped wave equation on the adjacency graph. Every panel has a
+    displacement, and each step it is pulled towards its neighbours and keeps moving the way it was going:
+
+        next = 2 * now - before + speed^2 * (sum of the neighbours' now - neighbours * now)
+
+    which is then damped a little. A beat kicks the displacement of one panel and the disturbance spreads out
+    from it one ring of neighbours after another, with overlapping ripples simply adding up.
+
+    R, G and B ripple independently in the lanes of one vector per panel, like DiffusionField.h. The step only
+    reads the current displacements and the previous one of the panel itself, so the next step is written over
+    the previous one: two buffers, swapped every step, and nothing is allocated after rippleInit().
+
+    The ripple rings are the same ripples evaluated in closed form from the layout cache's hop distance table
+    rather than stepped: each ripple is a ring of colour whose radius grows by the speed every frame and whose
+    strength falls by the damping, and a panel lights by how close its hop distance to the ripple's panel is to
+    the radius. A frame then costs one table read per panel per ripple, whatever the shape of the layout.
+ */
+
+#ifndef INC_RIPPLEFIELD_H_
+#define INC_RIPPLEFIELD_H_
+
+#include <stdint.h>
+#include "LayoutCache.h"
+
+// R, G, B and a lane that is always 0. Only 4 byte aligned so new[] on 32 bit targets is enough for it.
+typedef float ripple_colour_t __attribute__((vector_size(16), aligned(4)));
+
+typedef struct {
+    int nPanels;
+    const int* adjacencyStart;      // the neighbours of panel p are adjacency[adjacencyStart[p]] up to adjacency[adjacencyStart[p + 1]]
+    const int* adjacency;
+    ripple_colour_t* now;           // the displacement of each panel
+    ripple_colour_t* before;        // the displacement a step ago, overwritten with the next step
+    float* keep;                    // what a panel's own displacement counts for, 2 - neighbours * speed^2
+    float pull;                     // what each neighbour's displacement counts for, speed^2
+    float damping;                  // the next step is multiplied by this
+} ripple_field_t;
+
+/**
+ * @description: start with every panel at rest. The adjacency lists have to outlive the field.
+ * @param speed: how far a ripple moves per step in panels, lowered where it would make the step unstable
+ *               on the panel with the most neighbours
+ * @param damping: below 1 so ripples die away
+ */
+void rippleInit(ripple_field_t* field, int nPanels, const int* adjacencyStart, const int* adjacency, float speed, float damping);
+
+/**
+ * @description: kick the displacement of a panel, which starts a ripple from it
+ */
+void rippleLaunch(ripple_field_t* field, int panel, float R, float G, float B);
+
+/**
+ * @description: compute the next step of the panels [begin, end) over field->before. Calls with disjoint
+ * ranges can run concurrently; once every panel is done, rippleSwap() makes the step current.
+ */
+void rippleStepRange(ripple_field_t* field, int begin, int end);
+
+/**
+ * @description: make the step computed by rippleStepRange() the current displacements
+ */
+void rippleSwap(ripple_field_t* field);
+
+/**
+ * @description: free the field
+ */
+void rippleFree(ripple_field_t* field);
+
+// A ripple of the rings, launched at a panel
+typedef struct {
+    int panel;
+    int age;                        // frames since the launch
+    ripple_colour_t colour;         // the colour it was launched with
+    ripple_colour_t crest;          // the colour of the ring this frame, colour faded by damping^age
+    float radius;                   // the hop distance of the ring this frame, speed * age
+} ripple_ring_t;
+
+typedef struct {
+    int nPanels;
+    const layout_cache_t* layoutCache; // created with the hop distance table
+    ripple_ring_t* rings;
+    int capacity;
+    int count;
+    ripple_colour_t* now;           // the displacement of each panel, written by rippleRingsEvaluateRange()
+    float speed;
+    float damping;
+    float width;                    // panels up to this many hops off the radius are lit, fading linearly
+    int maxAge;                     // a ripple is dropped once it has faded below RIPPLE_RINGS_CUTOFF
+} ripple_rings_t;
+
+#define RIPPLE_RINGS_CUTOFF 0.01 // ripples that have faded to this fraction of their colour are dropped
+
+/**
+ * @description: start with no ripples. The layout cache has to outlive the rings.
+ * @param capacity: the most ripples at once, launching one more replaces the oldest
+ * @param speed: hops a ripple travels per frame
+ * @param damping: below 1 so ripples die away
+ * @param width: how many hops either side of its radius a ring reaches
+ */
+void rippleRingsInit(ripple_rings_t* rings, const layout_cache_t* layoutCache, int capacity, float speed, float damping, float width);
+
+/**
+ * @description: launch a ripple from a panel
+ */
+void rippleRingsLaunch(ripple_rings_t* rings, int panel, float R, float G, float B);
+
+/**
+ * @description: sum the ripples into the displacements of the panels [begin, end). Calls with disjoint ranges
+ * can run concurrently.
+ */
+void rippleRingsEvaluateRange(ripple_rings_t* rings, int begin, int end);
+
+/**
+ * @description: move every ripple on a frame and drop the ones that faded away
+ */
+void rippleRingsAdvance(ripple_rings_t* rings);
+
+/**
+ * @description: free the rings
+ */
+void rippleRingsFree(ripple_rings_t* rings);
+
+#endif /* INC_RIPPLEFIELD_H_ */
@@ -0,0 +1,763 @@
+/**
+    DancingTiles.cpp
+
+    Description:
+    Beat Detection, FFT to light source color and Panel Color calculations based on FrequncyStars by Nathan Dyck.
+    Spawns a new light source at the center of a random pane when beat detected color based on fft.
+    Increments age of sources every loop and removes a source either when array would be overflowed or age > lifespan.
+    All state lives in a dancing_tiles_t so any number of instances can run side by side, see DancingTiles.h.
+    In the DANCING_TILES_DIFFUSION and DANCING_TILES_RIPPLES modes there are no sources: beats inject colour into a
+    field that spreads over the panel adjacency graph every frame (see DiffusionField.h and RippleField.h), so a
+    frame costs the same however many beats fire.
+ */
+
+#include "DancingTiles.h"
+#include <stdlib.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "Logger.h"
+#include "RenderPool.h"
+#include "LayoutCache.h"
+#include "QualityGovernor.h"
+#include "BeatCalibration.h"
+#include "DetectorState.h"
+#include "BandMapper.h"
+#include "PanelOccupancy.h"
+#include "Prng.h"
+#include "DiffusionField.h"
+#include "RippleField.h"
+#include <algorithm>
+
+#define BASE_COLOUR_R 0 // these three settings defined the background colour; set to black
+#define BASE_COLOUR_G 0
+#define BASE_COLOUR_B 0
+#define ADJACENT_PANEL_DISTANCE 86.599995   // hard coded distance between adjacent panels; this ideally should be autodetected
+#define TRANSITION_TIME 1  // the transition time to send to panels; set to 100ms currently
+#define MINIMUM_INTENSITY 0.2  // the minimum intensity of a source
+#define TRIGGER_THRESHOLD 0.7 // used to calculate whether to add a source
+//Light source consts
+#define SPAWN_AMOUNT 1
+#define LIFESPAN 1 //the max number of cycles a source will live
+//Light Diffusion consts
+#define TEMPO_DIVISOR 25 //default is 25
+#define TEMPO_ENABLED false //determines if the tempo is taken into consideration for the diffusion
+#define MININMUM_MULTIPLIER 1.5//minimum multiplier value used. Default is 1.5
+#define INFLUENCE_ERROR_BOUND 0.01 //a source is skipped on panels where it would mix in less than this fraction of its colour
+//Rendering consts
+#define RENDER_THREADS 0 //extra worker threads used to render the panels, 0 renders everything on the calling thread
+#define PARALLEL_RENDER_MIN_PANELS 128 //below this many panels the worker threads cost more than they save
+#define LAYOUT_CACHE_PATH NULL //file the layout derived data is kept in between loads, e.g. "/tmp/DancingTiles.layout". NULL disables it
+#define LOG_LAYOUT false //print every palette colour and panel position on start-up
+#define RANDOM_SEED 48 //seeds the panel choice, fixed so every load plays the same way as with the unseeded drand48()
+//Quality governor consts
+#define FRAME_BUDGET_MS 20 //a rendered frame should cost no more than this, 0 always renders at full quality
+#define REDUCED_SOURCES_DIVISOR 4 //from QUALITY_CAP_SOURCES only this fraction of MAX_SOURCES may be alive
+#define TIGHT_INFLUENCE_ERROR_BOUND 0.05 //from QUALITY_TIGHT_RADIUS sources are skipped where they mix in less than this
+
+#define RENDER_MODE DANCING_TILES_SOURCES //what beats do to the panels, see dancing_tiles_mode_t
+#define DIFFUSION_RATE 0.15 //share of the colour difference that flows between two adjacent panels per frame
+#define DIFFUSION_FADE 0.8 //the diffusing colours are multiplied by this every frame
+#define RIPPLE_SPEED 0.7 //panels a ripple travels per frame
+#define RIPPLE_DAMPING 0.93 //the ripples are multiplied by this every frame
+#define RIPPLE_KICK 2.0 //a beat kicks its panel by this times the colour of the beat
+#define RIPPLE_HOP_TABLE false //evaluate the ripples from the hop distance table instead of stepping the wave equation
+#define RIPPLE_RING_WIDTH 1.5 //with the hop table, panels up to this many hops either side of a ring are lit
+#define RIPPLE_RING_CAPACITY 64 //with the hop table, the most ripples at once
+
+// Here we store the information accociated with each light source like current
+// position, velocity and colour. The information is stored in a list called sources.
+typedef struct {
+    float x;
+    float y;
+    int R;
+    int G;
+    int B;
+    int age;
+    int panel; // index of the panel the source was spawned on
+} source_t;
+
+typedef struct {
+    float R;
+    float G;
+    float B;
+} colour_acc_t;
+
+/** Here we store the information accociated with each frequency bin. This
+ allows for tracking a degree of historical information.
+ */
+typedef struct {
+    uint32_t latest_minimum;
+    uint32_t soundPower;
+    int16_t colour;
+    uint32_t runningMax;
+    uint32_t runningMin;
+    uint32_t maximumTrigger;
+    uint32_t previousPower;
+    uint32_t secondPreviousPower;
+} freq_bin;
+
+struct dancing_tiles_t {
+    RGB_t* palette;                 // the colour palette, owned by the caller
+    int nColors;                    // the number of colours of the palette in use
+    LayoutData* layoutData;         // the panel layout, owned by the caller
+    layout_cache_t* layoutCache;    // adjacency, influence lists and spatial index of the layout
+    source_t* sources;              // this is our array for sources
+    int nSources;
+    int maxSources;
+    panel_occupancy_t occupancy;    // the panels a source sits on, new sources go to a free panel
+    prng_t prng;                    // this instance's random numbers
+    freq_bin* freqBins;             // this is our array for frequency bin historical information.
+    band_mapper_t bandMapper;       // maps the fft onto one band per palette colour
+    uint8_t* bandPowers;            // the band powers of the current frame
+    render_pool_t* renderPool;      // worker threads for the render loop, NULL when rendering single threaded
+    float renderedMultiplier;       // falloff multiplier the panels were last rendered with
+    colour_acc_t* panelColours;     // per panel colour accumulators used while rendering
+    bool* panelDirty;               // panels whose colour has to be recomputed for the next frame
+    bool anyDirty;
+    RGB_t* panelShown;              // the colour last sent to each panel
+    beat_calibration_t calibration; // levels of the first frames, the frequency bins are seeded from them
+    float tempo;                    // the last tempo the host reported, stands in while the host has none yet
+    quality_governor_t governor;    // steps the quality down when frames run over FRAME_BUDGET_MS
+    int renderedLevel;              // quality level the panels were last rendered at
+    unsigned int frameCount;
+    dancing_tiles_mode_t mode;      // what beats do to the panels
+    diffusion_field_t diffusion;    // the field of DANCING_TILES_DIFFUSION
+    ripple_field_t ripples;         // the field of DANCING_TILES_RIPPLES
+    bool rippleHops;                // the ripples are rings evaluated from the hop distances instead
+    ripple_rings_t rings;           // the ripples of DANCING_TILES_RIPPLES with rippleHops
+};
+
+// What a render pool slice gets handed
+typedef struct {
+    dancing_tiles_t* instance;
+    Frame_t* frames;
+    const frame_uniforms_t* uniforms;
+    float maxD2;                    // sources are skipped on panels further away than this
+    bool cheapKernel;               // use the linear falloff
+} render_job_t;
+
+/**
+  * @description: add a value to a running max.
+  * @param: runningMax is current runningMax, valueToAdd is added to runningMax, effectiveTrail
+  *         defines how many values are effectively tracked. Note this is an approximation.
+  * @return: int returned as new runningMax.
+  */
+static int addToRunningMax(int runningMax, int valueToAdd, int effectiveTrail) {
+    int trail = effectiveTrail;
+    if (valueToAdd > runningMax && effectiveTrail > 1) {
+        trail = trail / 2;
+    }
+    return runningMax - ((float)runningMax / effectiveTrail) + ((float)valueToAdd / trail);
+}
+
+void dancingTilesDefaultConfig(dancing_tiles_config_t* config)
+{
+    config->renderThreads = RENDER_THREADS;
+    config->parallelMinPanels = PARALLEL_RENDER_MIN_PANELS;
+    config->layoutCachePath = LAYOUT_CACHE_PATH;
+    config->frameBudgetMs = FRAME_BUDGET_MS;
+    config->randomSeed = RANDOM_SEED;
+    config->mode = RENDER_MODE;
+    config->rippleHops = RIPPLE_HOP_TABLE;
+}
+
+dancing_tiles_t* dancingTilesCreate(LayoutData* layoutData, RGB_t* palette, int nColors, const dancing_tiles_config_t* config)
+{
+    dancing_tiles_config_t defaults;
+    if(config == NULL) {
+        dancingTilesDefaultConfig(&defaults);
+        config = &defaults;
+    }
+
+    dancing_tiles_t* instance = new dancing_tiles_t();
+    instance->layoutData = layoutData;
+    instance->palette = palette;
+    instance->nColors = nColors;
+    PRINTLOG("The palette has %d nColors:\n", nColors);
+    int maxPaletteColors = layoutData->nPanels - 2;   // if more nColors then this, we will use just the first this many
+    instance->maxSources = layoutData->nPanels * LIFESPAN;  // maxiumum sources
+    PRINTLOG("MAX_SOURCES: %d\n", instance->maxSources);
+
+    if(instance->nColors > maxPaletteColors) {
+        PRINTLOG("There are too many nColors in the palette. using only the first %d\n", maxPaletteColors);
+        instance->nColors = maxPaletteColors;
+    }
+    instance->sources = new source_t[instance->maxSources];
+    instance->nSources = 0;
+    occupancyInit(&instance->occupancy, layoutData->nPanels);
+    prngSeed(&instance->prng, config->randomSeed);
+    if(LOG_LAYOUT) {
+        for (int i = 0; i < instance->nColors; i++) {
+            PRINTLOG("   %d %d %d\n", palette[i].R, palette[i].G, palette[i].B);
+        }
+    }
+
+    PRINTLOG("The layout has %d panels\n", layoutData->nPanels);
+    if(LOG_LAYOUT) {
+        for (int i = 0; i < layoutData->nPanels; i++) {
+            PRINTLOG("   Id: %d   X, Y: %lf, %lf\n", layoutData->panels[i].panelId,
+                   layoutData->panels[i].shape->getCentroid().x, layoutData->panels[i].shape->getCentroid().y);
+        }
+    }
+
+    instance->freqBins = new freq_bin[maxPaletteColors > 0 ? maxPaletteColors : 0]();
+    // the freqency bin values are seeded from the first few frames so that the plugin starts working reasonably well right away
+    calibrationInit(&instance->calibration, instance->nColors);
+    bandMapperInit(&instance->bandMapper, BAND_MAPPER_FFT_BINS, instance->nColors);
+    instance->bandPowers = new uint8_t[instance->nColors > 0 ? instance->nColors : 1]();
+    instance->panelColours = new colour_acc_t[layoutData->nPanels];
+    instance->panelDirty = new bool[layoutData->nPanels];
+    instance->panelShown = new RGB_t[layoutData->nPanels];
+    for (int i = 0; i < layoutData->nPanels; i++) {
+        instance->panelDirty[i] = true;
+        instance->panelShown[i].R = -1;
+        instance->panelShown[i].G = -1;
+        instance->panelShown[i].B = -1;
+    }
+    instance->anyDirty = true;
+    instance->renderedMultiplier = MININMUM_MULTIPLIER;
+    governorInit(&instance->governor, config->frameBudgetMs);
+    instance->renderedLevel = QUALITY_FULL;
+    instance->frameCount = 0;
+
+    // A source at a distance of d panels mixes in 1 / (d^2 * multiplier + 1) of its colour. Past the distance where
+    // that drops below INFLUENCE_ERROR_BOUND the source is ignored, so each skipped source moves a colour channel by
+    // at most INFLUENCE_ERROR_BOUND * 255. The smallest multiplier gives the widest falloff the tempo can produce.
+    float influenceRadius = sqrt((1.0 / INFLUENCE_ERROR_BOUND - 1.0) / MININMUM_MULTIPLIER);
+    // only the ripple rings read the hop distances, building them is most of the cost of the cache
+    bool hopDistances = config->mode == DANCING_TILES_RIPPLES && config->rippleHops;
+    instance->layoutCache = layoutCacheCreate(layoutData, ADJACENT_PANEL_DISTANCE, influenceRadius, hopDistances, config->layoutCachePath);
+    instance->renderPool = renderPoolCreate(config->renderThreads, config->parallelMinPanels);
+    instance->mode = config->mode;
+    if(instance->mode == DANCING_TILES_DIFFUSION) {
+        diffusionInit(&instance->diffusion, layoutData->nPanels, instance->layoutCache->adjacencyStart,
+                      instance->layoutCache->adjacency, DIFFUSION_RATE, DIFFUSION_FADE);
+    }
+    else if(instance->mode == DANCING_TILES_RIPPLES && hopDistances) {
+        instance->rippleHops = true;
+        rippleRingsInit(&instance->rings, instance->layoutCache, RIPPLE_RING_CAPACITY, RIPPLE_SPEED, RIPPLE_DAMPING, RIPPLE_RING_WIDTH);
+    }
+    else if(instance->mode == DANCING_TILES_RIPPLES) {
+        rippleInit(&instance->ripples, layoutData->nPanels, instance->layoutCache->adjacencyStart,
+                   instance->layoutCache->adjacency, RIPPLE_SPEED, RIPPLE_DAMPING);
+    }
+    return instance;
+}
+
+int dancingTilesFftBins(const dancing_tiles_t* instance)
+{
+    return instance->bandMapper.nFftBins;
+}
+
+/** Flags every panel within the influence radius of a source for re-rendering */
+static void markSourceDirty(dancing_tiles_t* instance, int idx)
+{
+    const layout_cache_t* layoutCache = instance->layoutCache;
+    int panel = instance->sources[idx].panel;
+    for(int i = layoutCache->influenceStart[panel]; i < layoutCache->influenceStart[panel + 1]; i++) {
+        instance->panelDirty[layoutCache->influence[i].panel] = true;
+    }
+    instance->anyDirty = true;
+}
+
+/** Removes a light source from the list of light sources */
+static void removeSource(dancing_tiles_t* instance, int idx)
+{
+    markSourceDirty(instance, idx);
+    occupancyRelease(&instance->occupancy, instance->sources[idx].panel);
+    memmove(instance->sources + idx, instance->sources + idx + 1, sizeof(source_t) * (instance->nSources - idx - 1));
+    instance->nSources--;
+}
+
+/**
+  * @description: Adds a light source to the list of light sources. The light source will have a particular colour
+  * and intensity and will move at a particular speed.
+*/
+static void addSource(dancing_tiles_t* instance, int paletteIndex, float intensity)
+{
+    const layout_view_t* view = &instance->layoutCache->view;
+    float x;
+    float y;
+
+    // we need at least two panels to do anything meaningful in here
+    if(view->nPanels < 2) {
+        return;
+    }
+    if(instance->mode == DANCING_TILES_DIFFUSION) {
+        // the colour goes into the field at a random panel and spreads from there
+        const RGB_t* colour = &instance->palette[paletteIndex];
+        for(int i = 0; i < SPAWN_AMOUNT; i++) {
+            int n1 = prngBounded(&instance->prng, view->nPanels);
+            diffusionInject(&instance->diffusion, n1, colour->R * intensity, colour->G * intensity, colour->B * intensity);
+        }
+        return;
+    }
+    if(instance->mode == DANCING_TILES_RIPPLES) {
+        // a random panel is knocked and the ripple runs outward from it
+        const RGB_t* colour = &instance->palette[paletteIndex];
+        float kick = RIPPLE_KICK * intensity;
+        for(int i = 0; i < SPAWN_AMOUNT; i++) {
+            int n1 = prngBounded(&instance->prng, view->nPanels);
+            if(instance->rippleHops) {
+                // a ring is not spread out over the panels like the wave, it starts at the colour of the beat
+                rippleRingsLaunch(&instance->rings, n1, colour->R * intensity, colour->G * intensity, colour->B * intensity);
+            } else {
+                rippleLaunch(&instance->ripples, n1, colour->R * kick, colour->G * kick, colour->B * kick);
+            }
+        }
+        return;
+    }
+    for(int i = 0; i < SPAWN_AMOUNT; i++){
+        // if we have a lot of light sources already, let's bump off the oldest one
+        int maxSources = instance->maxSources;
+        if(instance->governor.level >= QUALITY_CAP_SOURCES) {
+            maxSources = std::max(1, maxSources / REDUCED_SOURCES_DIVISOR);
+        }
+        while(instance->nSources >= maxSources) {
+            removeSource(instance, 0);
+        }
+
+        // pick a random panel that has no source on it yet, bumping off the oldest sources if there is none
+        int n1 = occupancyRandomFree(&instance->occupancy, &instance->prng);
+        while(n1 < 0 && instance->nSources > 0) {
+            removeSource(instance, 0);
+            n1 = occupancyRandomFree(&instance->occupancy, &instance->prng);
+        }
+        occupancyTake(&instance->occupancy, n1);
+        x = view->x[n1];
+        y = view->y[n1];
+
+        // decide in the colour of this light source and factor in the intensity to arrive at an RGB value
+        int R = instance->palette[paletteIndex].R;
+        int G = instance->palette[paletteIndex].G;
+        int B = instance->palette[paletteIndex].B;
+        R *= intensity;
+        G *= intensity;
+        B *= intensity;
+
+        // add all the information to the list of light sources
+        source_t* source = &instance->sources[instance->nSources];
+        source->x = x;
+        source->y = y;
+        source->R = (int)R;
+        source->G = (int)G;
+        source->B = (int)B;
+        source->age = 0;
+        source->panel = n1;
+        markSourceDirty(instance, instance->nSources);
+        instance->nSources++;
+    }
+}
+
+/**
+  * @description: This function will render the colour of the panels [begin, end) given the positions of
+  * all the lights in the light source list. Each call only writes its own frames so the panel range can be
+  * split across the render pool. Panels that are not flagged dirty keep their colour and are skipped.
+  */
+static void renderPanelRange(int begin, int end, void *arg)
+{
+    const render_job_t* job = (const render_job_t*)arg;
+    const dancing_tiles_t* instance = job->instance;
+    const layout_cache_t* layoutCache = instance->layoutCache;
+    const source_t* sources = instance->sources;
+    const bool* panelDirty = instance->panelDirty;
+    colour_acc_t* panelColours = instance->panelColours;
+    Frame_t* frames = job->frames;
+    const float multiplier = job->uniforms->multiplier;
+    const float maxD2 = job->maxD2;
+    const float inverseMaxD2 = 1.0 / maxD2;
+    const bool cheapKernel = job->cheapKernel;
+    int i;
+    for(i = begin; i < end; i++) {
+        if(panelDirty[i]) {
+            panelColours[i].R = BASE_COLOUR_R;
+            panelColours[i].G = BASE_COLOUR_G;
+            panelColours[i].B = BASE_COLOUR_B;
+        }
+    }
+
+    // Iterate through all the sources
+    // Depending how close the source is to the panel, we take some fraction of its colour and mix it into an
+    // accumulator. Newest sources have the most weight. Old sources die away until they are gone.
+    // Only the panels on the source's influence list are visited, the rest would get next to nothing.
+    for(int s = 0; s < instance->nSources; s++) {
+        const influence_t* first = layoutCache->influence + layoutCache->influenceStart[sources[s].panel];
+        const influence_t* last = layoutCache->influence + layoutCache->influenceStart[sources[s].panel + 1];
+        const influence_t* it = std::lower_bound(first, last, begin,
+            [](const influence_t& entry, int panel) { return entry.panel < panel; });
+        for(; it != last && it->panel < end; it++) {
+            if(!panelDirty[it->panel] || it->d2 > maxD2) {
+                continue;
+            }
+            float factor;
+            if(cheapKernel) {
+                factor = 1.0 - it->d2 * inverseMaxD2; // falls off linearly to 0 at the edge of the tight radius, no division
+            } else {
+                factor = 1.0 / (it->d2 * multiplier + 1.0);// determines how much of the source's colour we mix in (depends on distance)
+                                                      // the formula is not based on physics, it is fudged to get a good effect
+                                                      // the formula yields a number between 0 and 1
+            }
+            colour_acc_t* colour = &panelColours[it->panel];
+            colour->R = colour->R * (1.0 - factor) + sources[s].R * factor;
+            colour->G = colour->G * (1.0 - factor) + sources[s].G * factor;
+            colour->B = colour->B * (1.0 - factor) + sources[s].B * factor;
+        }
+    }
+
+    for(i = begin; i < end; i++) {
+        if(!panelDirty[i]) {
+            continue;
+        }
+        frames[i].panelId = layoutCache->view.panelIds[i];
+        frames[i].r = (int)panelColours[i].R;
+        frames[i].g = (int)panelColours[i].G;
+        frames[i].b = (int)panelColours[i].B;
+        frames[i].transTime = TRANSITION_TIME;
+    }
+}
+
+/** Render pool callback advancing the diffusion of a range of panels */
+static void diffusePanelRange(int begin, int end, void *arg)
+{
+    diffusionStepRange((diffusion_field_t*)arg, begin, end);
+}
+
+/** Render pool callback advancing the ripples of a range of panels */
+static void ripplePanelRange(int begin, int end, void *arg)
+{
+    rippleStepRange((ripple_field_t*)arg, begin, end);
+}
+
+/** Render pool callback evaluating the ripple rings on a range of panels */
+static void ringPanelRange(int begin, int end, void *arg)
+{
+    rippleRingsEvaluateRange((ripple_rings_t*)arg, begin, end);
+}
+
+/**
+  * @description: write a frame for a panel if its colour changed since it was last sent
+  * @return: the number of frames written, 0 or 1
+  */
+static int emitChangedPanel(dancing_tiles_t* instance, int panel, int R, int G, int B, Frame_t* frame)
+{
+    RGB_t* shown = &instance->panelShown[panel];
+    if(R == shown->R && G == shown->G && B == shown->B) {
+        return 0;
+    }
+    shown->R = R;
+    shown->G = G;
+    shown->B = B;
+    frame->panelId = instance->layoutCache->view.panelIds[panel];
+    frame->r = R;
+    frame->g = G;
+    frame->b = B;
+    frame->transTime = TRANSITION_TIME;
+    return 1;
+}
+
+/**
+  * @description: advance the diffusion by a step and write a frame for every panel whose colour changed
+  * @return: the number of frames written
+  */
+static int renderDiffusion(dancing_tiles_t* instance, Frame_t* frames)
+{
+    const int nPanels = instance->layoutData->nPanels;
+    renderPoolRun(instance->renderPool, diffusePanelRange, &instance->diffusion, nPanels);
+    diffusionSwap(&instance->diffusion);
+    int nChanged = 0;
+    for(int i = 0; i < nPanels; i++) {
+        const diffusion_colour_t& colour = instance->diffusion.colours[i];
+        int R = std::min((int)(BASE_COLOUR_R + colour[0]), 255);
+        int G = std::min((int)(BASE_COLOUR_G + colour[1]), 255);
+        int B = std::min((int)(BASE_COLOUR_B + colour[2]), 255);
+        nChanged += emitChangedPanel(instance, i, R, G, B, frames + nChanged);
+    }
+    return nChanged;
+}
+
+/**
+  * @description: advance the ripples by a step and write a frame for every panel whose colour changed. Crests
+  * and troughs both light a panel, so a ripple shows as a ring of colour moving outward.
+  * @return: the number of frames written
+  */
+static int renderRipples(dancing_tiles_t* instance, Frame_t* frames)
+{
+    const int nPanels = instance->layoutData->nPanels;
+    const ripple_colour_t* displacement;
+    if(instance->rippleHops) {
+        renderPoolRun(instance->renderPool, ringPanelRange, &instance->rings, nPanels);
+        rippleRingsAdvance(&instance->rings);
+        displacement = instance->rings.now;
+    } else {
+        renderPoolRun(instance->renderPool, ripplePanelRange, &instance->ripples, nPanels);
+        rippleSwap(&instance->ripples);
+        displacement = instance->ripples.now;
+    }
+    int nChanged = 0;
+    for(int i = 0; i < nPanels; i++) {
+        const ripple_colour_t& colour = displacement[i];
+        int R = std::min((int)(BASE_COLOUR_R + fabsf(colour[0])), 255);
+        int G = std::min((int)(BASE_COLOUR_G + fabsf(colour[1])), 255);
+        int B = std::min((int)(BASE_COLOUR_B + fabsf(colour[2])), 255);
+        nChanged += emitChangedPanel(instance, i, R, G, B, frames + nChanged);
+    }
+    return nChanged;
+}
+
+/**
+  * A simple algorithm to detect beats. It finds a strong signal after a period of quietness.
+  * Actually, it doesn't detect just beats. For example, classical music often doesn't have
+  * strong beats but it has strong instrumental sections. Those would also get detected.
+  */
+static int16_t beat_detector(freq_bin* bin)
+{
+    int16_t beat_detected = 0;
+
+    //Check for local maximum and if observed, add to running average
+    if((bin->soundPower + (bin->runningMax / 4) < bin->previousPower) && (bin->previousPower > bin->secondPreviousPower)){
+        bin->runningMax = addToRunningMax(bin->runningMax, bin->previousPower, 4);
+    }
+
+    // update latest minimum.
+    if(bin->soundPower < bin->latest_minimum) {
+        bin->latest_minimum = bin->soundPower;
+    }
+    else if(bin->latest_minimum > 0) {
+        bin->latest_minimum--;
+    }
+
+    // criteria for a "beat"; value must exceed minimum plus a threshold of the runningMax.
+    if(bin->soundPower > bin->latest_minimum + (bin->runningMax * TRIGGER_THRESHOLD)) {
+        bin->latest_minimum = bin->soundPower;
+        beat_detected = 1;
+    }
+
+    // update historical information
+    bin->secondPreviousPower = bin->previousPower;
+    bin->previousPower = bin->soundPower;
+
+    return beat_detected;
+}
+
+/**
+  * @description: seed the detector of every bin from the levels seen during calibration: the minimum starts at the
+  * noise floor and the running max at the peak level, and the last two frames become the detector's history.
+  */
+static void seedFreqBins(dancing_tiles_t* instance)
+{
+    const beat_calibration_t* calibration = &instance->calibration;
+    for(int i = 0; i < instance->nColors; i++) {
+        freq_bin* bin = &instance->freqBins[i];
+        bin->latest_minimum = calibrationNoiseFloor(calibration, i);
+        bin->runningMax = std::max((int)calibrationPeak(calibration, i), 1);
+        bin->maximumTrigger = bin->runningMax;
+        bin->previousPower = calibration->last[i];
+        bin->secondPreviousPower = calibration->secondLast[i];
+    }
+    PRINTLOG("Calibrated after %d frames\n", calibration->frames);
+}
+
+void dancingTilesDeriveUniforms(dancing_tiles_t* instance, frame_uniforms_t* uniforms)
+{
+    if(uniforms->tempo > 0) {
+        instance->tempo = uniforms->tempo;
+    } else {
+        uniforms->tempo = instance->tempo;
+    }
+
+    // derive the per frame constants once rather than once per panel and source
+    uniforms->multiplier = MININMUM_MULTIPLIER;
+    if(TEMPO_ENABLED) {
+        uniforms->multiplier = log(uniforms->tempo + 2) + MININMUM_MULTIPLIER;
+    }
+}
+
+void dancingTilesFrame(dancing_tiles_t* instance, const frame_uniforms_t* uniforms, Frame_t* frames, int* nFrames)
+{
+    int i;
+    const int nPanels = instance->layoutData->nPanels;
+    *nFrames = 0;
+
+    // one band per palette colour from the full fft
+    bandMapperApply(&instance->bandMapper, uniforms->fftBins, instance->bandPowers);
+    const uint8_t* bandPowers = instance->bandPowers;
+
+    if(!calibrationDone(&instance->calibration)) {
+        if(calibrationAdd(&instance->calibration, bandPowers)) {
+            seedFreqBins(instance);
+        }
+        return;
+    }
+
+    uint64_t frameStart = governorNow();
+    instance->frameCount++;
+
+    // Compute the sound power (or volume) in each bin
+    for(i = 0; i < instance->nColors; i++) {
+        freq_bin* bin = &instance->freqBins[i];
+        bin->soundPower = bandPowers[i];
+        uint8_t beat_detected = beat_detector(bin);
+
+        if(beat_detected) {
+            if (bin->soundPower > bin->maximumTrigger) {
+                bin->maximumTrigger = bin->soundPower;
+            }
+
+            float intensity = 1.0;
+
+            //calculate an intensity ranging from minimum to 1, using log scale
+            if (bin->soundPower > 1 && bin->runningMax > 1){
+                intensity = ((log((float)bin->soundPower) / log((float)bin->runningMax)) * (1.0 - MINIMUM_INTENSITY)) + MINIMUM_INTENSITY;
+            }
+
+            if (intensity > 1.0) {
+                intensity = 1.0;
+            }
+
+            // add a new light source for each beat detected
+            addSource(instance, i, intensity);
+        }
+    }
+
+    if(instance->mode == DANCING_TILES_DIFFUSION) {
+        *nFrames = renderDiffusion(instance, frames);
+        return;
+    }
+    if(instance->mode == DANCING_TILES_RIPPLES) {
+        *nFrames = renderRipples(instance, frames);
+        return;
+    }
+
+    const int level = instance->governor.level;
+    if(uniforms->multiplier != instance->renderedMultiplier || level != instance->renderedLevel) {
+        // the falloff changed shape, every panel is affected
+        instance->renderedMultiplier = uniforms->multiplier;
+        instance->renderedLevel = level;
+        for(i = 0; i < nPanels; i++) {
+            instance->panelDirty[i] = true;
+        }
+        instance->anyDirty = true;
+    }
+
+    // render the panels touched by a source that spawned or died since the last frame, and only send
+    // the ones that actually changed colour. If nothing changed there is nothing to send.
+    // When skipping frames the dirty panels are left for the next frame.
+    int nChanged = 0;
+    bool rendered = false;
+    if(instance->anyDirty && (level < QUALITY_SKIP_FRAMES || (instance->frameCount & 1) == 0)) {
+        render_job_t job;
+        job.instance = instance;
+        job.frames = frames;
+        job.uniforms = uniforms;
+        job.maxD2 = HUGE_VALF; // the influence lists already stop at INFLUENCE_ERROR_BOUND
+        if(level >= QUALITY_TIGHT_RADIUS) {
+            job.maxD2 = (1.0 / TIGHT_INFLUENCE_ERROR_BOUND - 1.0) / uniforms->multiplier;
+        }
+        job.cheapKernel = level >= QUALITY_CHEAP_KERNEL;
+        rendered = true;
+        renderPoolRun(instance->renderPool, renderPanelRange, &job, nPanels);
+        bool* panelDirty = instance->panelDirty;
+        RGB_t* panelShown = instance->panelShown;
+        for(i = 0; i < nPanels; i++) {
+            if(!panelDirty[i]) {
+                continue;
+            }
+            panelDirty[i] = false;
+            if(frames[i].r == panelShown[i].R && frames[i].g == panelShown[i].G && frames[i].b == panelShown[i].B) {
+                continue;
+            }
+            panelShown[i].R = frames[i].r;
+            panelShown[i].G = frames[i].g;
+            panelShown[i].B = frames[i].b;
+            frames[nChanged++] = frames[i]; // nChanged <= i so this never clobbers a frame still to be read
+        }
+        instance->anyDirty = false;
+    }
+    if(instance->nSources > 0){ // just to keep the logs from filling up to much
+      PRINTLOG("#sources: %d\n", instance->nSources);
+    }
+    for(i = 0; i < instance->nSources; i++) {
+      if(instance->sources[i].age == LIFESPAN) {
+        removeSource(instance, 0);
+      } else {
+        instance->sources[i].age++;
+      }
+    }
+
+    if(TEMPO_ENABLED) {
+      PRINTLOG("Tempo: %f Tempo Multi: %f\n", uniforms->tempo, uniforms->multiplier);
+    }
+
+    // frames that render nothing cost next to nothing and say little about the headroom
+    if(rendered && governorUpdate(&instance->governor, governorNow() - frameStart)) {
+        PRINTLOG("Quality level: %d\n", instance->governor.level);
+    }
+    *nFrames = nChanged;
+}
+
+bool dancingTilesRestoreDetector(dancing_tiles_t* instance, const char* path)
+{
+    if(path == NULL) {
+        return false;
+    }
+    detector_bin_state_t* saved = new detector_bin_state_t[instance->nColors > 0 ? instance->nColors : 1];
+    float tempo = 0;
+    bool restored = detectorStateLoad(path, saved, instance->nColors, &tempo);
+    if(restored) {
+        for(int i = 0; i < instance->nColors; i++) {
+            freq_bin* bin = &instance->freqBins[i];
+            bin->latest_minimum = saved[i].latestMinimum;
+            bin->runningMax = std::max(saved[i].runningMax, (uint32_t)1);
+            bin->maximumTrigger = saved[i].maximumTrigger;
+        }
+        instance->tempo = tempo;
+        calibrationSkip(&instance->calibration);
+        PRINTLOG("Detector state restored from %s\n", path);
+    }
+    delete [] saved;
+    return restored;
+}
+
+void dancingTilesSaveDetector(const dancing_tiles_t* instance, const char* path)
+{
+    if(path == NULL || !calibrationDone(&instance->calibration)) {
+        return; // the constants we started from are not worth keeping
+    }
+    detector_bin_state_t* state = new detector_bin_state_t[instance->nColors > 0 ? instance->nColors : 1];
+    for(int i = 0; i < instance->nColors; i++) {
+        state[i].latestMinimum = instance->freqBins[i].latest_minimum;
+        state[i].runningMax = instance->freqBins[i].runningMax;
+        state[i].maximumTrigger = instance->freqBins[i].maximumTrigger;
+    }
+    detectorStateSave(path, state, instance->nColors, instance->tempo);
+    delete [] state;
+}
+
+void dancingTilesDestroy(dancing_tiles_t* instance)
+{
+    if(instance == NULL) {
+        return;
+    }
+    renderPoolDestroy(instance->renderPool);
+    layoutCacheDestroy(instance->layoutCache);
+    delete [] instance->sources;
+    occupancyFree(&instance->occupancy);
+    delete [] instance->freqBins;
+    calibrationFree(&instance->calibration);
+    bandMapperFree(&instance->bandMapper);
+    delete [] instance->bandPowers;
+    delete [] instance->panelColours;
+    delete [] instance->panelDirty;
+    delete [] instance->panelShown;
+    if(instance->mode == DANCING_TILES_DIFFUSION) {
+        diffusionFree(&instance->diffusion);
+    }
+    else if(instance->mode == DANCING_TILES_RIPPLES && instance->rippleHops) {
+        rippleRingsFree(&instance->rings);
+    }
+    else if(instance->mode == DANCING_TILES_RIPPLES) {
+        rippleFree(&instance->ripples);
+    }
+    delete instance;
+}
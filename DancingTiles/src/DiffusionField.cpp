@@ -0,0 +1,70 @@
+/**
+    DiffusionField.cpp
+
+    Description:
+    The Laplacian diffusion of panel colours, see DiffusionField.h.
+ */
+
+#include "DiffusionField.h"
+#include <stddef.h>
+#include <algorithm>
+
+void diffusionInit(diffusion_field_t* field, int nPanels, const int* adjacencyStart, const int* adjacency, float rate, float fade)
+{
+    field->nPanels = nPanels;
+    field->adjacencyStart = adjacencyStart;
+    field->adjacency = adjacency;
+    field->colours = new diffusion_colour_t[nPanels]();
+    field->next = new diffusion_colour_t[nPanels]();
+    field->keep = new float[nPanels];
+
+    // a panel with n neighbours keeps 1 - n * rate of its colour, which has to stay positive or the colours
+    // start to oscillate and blow up
+    int maxDegree = 0;
+    for(int p = 0; p < nPanels; p++) {
+        maxDegree = std::max(maxDegree, adjacencyStart[p + 1] - adjacencyStart[p]);
+    }
+    if(maxDegree > 0) {
+        rate = std::min(rate, 1.0f / (maxDegree + 1));
+    }
+    for(int p = 0; p < nPanels; p++) {
+        field->keep[p] = (1.0 - (adjacencyStart[p + 1] - adjacencyStart[p]) * rate) * fade;
+    }
+    field->take = rate * fade;
+}
+
+void diffusionInject(diffusion_field_t* field, int panel, float R, float G, float B)
+{
+    diffusion_colour_t colour = {R, G, B, 0};
+    field->colours[panel] += colour;
+}
+
+void diffusionStepRange(diffusion_field_t* field, int begin, int end)
+{
+    const int* adjacencyStart = field->adjacencyStart;
+    const int* adjacency = field->adjacency;
+    const diffusion_colour_t* colours = field->colours;
+    diffusion_colour_t* next = field->next;
+    for(int p = begin; p < end; p++) {
+        diffusion_colour_t inflow = {0, 0, 0, 0};
+        for(int i = adjacencyStart[p]; i < adjacencyStart[p + 1]; i++) {
+            inflow += colours[adjacency[i]];
+        }
+        next[p] = colours[p] * field->keep[p] + inflow * field->take;
+    }
+}
+
+void diffusionSwap(diffusion_field_t* field)
+{
+    std::swap(field->colours, field->next);
+}
+
+void diffusionFree(diffusion_field_t* field)
+{
+    delete [] field->colours;
+    delete [] field->next;
+    delete [] field->keep;
+    field->colours = NULL;
+    field->next = NULL;
+    field->keep = NULL;
+}
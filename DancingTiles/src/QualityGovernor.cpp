@@ -0,0 +1,71 @@
+/**
+    QualityGovernor.cpp
+
+    Description:
+    Frame time governor, see QualityGovernor.h.
+    The frame cost is smoothed with an exponential moving average so a single slow frame (a page fault, the
+    host being busy) does not change the quality. Stepping down needs the average over the budget for a few
+    frames in a row, stepping up needs it under a fraction of the budget for much longer, so the level does
+    not flip back and forth around the budget.
+ */
+
+#include "QualityGovernor.h"
+#include <time.h>
+
+#define GOVERNOR_AVERAGE_SHIFT 3        // the average moves 1/8 of the way towards each new frame cost
+#define GOVERNOR_STEP_DOWN_FRAMES 3     // frames over the budget before the quality drops a level
+#define GOVERNOR_STEP_UP_FRAMES 40      // frames under the step up threshold before the quality rises a level
+#define GOVERNOR_STEP_UP_PERCENT 60     // step up threshold as a percentage of the budget
+
+void governorInit(quality_governor_t* governor, float budgetMs)
+{
+    governor->budgetNs = budgetMs > 0 ? (uint64_t)(budgetMs * 1e6) : 0;
+    governor->averageNs = 0;
+    governor->level = QUALITY_FULL;
+    governor->overBudget = 0;
+    governor->underBudget = 0;
+}
+
+uint64_t governorNow()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+bool governorUpdate(quality_governor_t* governor, uint64_t frameNs)
+{
+    if(governor->budgetNs == 0) {
+        return false;
+    }
+    if(governor->averageNs == 0) {
+        governor->averageNs = frameNs;
+    } else {
+        governor->averageNs += ((int64_t)frameNs - (int64_t)governor->averageNs) >> GOVERNOR_AVERAGE_SHIFT;
+    }
+
+    if(governor->averageNs > governor->budgetNs) {
+        governor->overBudget++;
+        governor->underBudget = 0;
+    } else if(governor->averageNs * 100 < governor->budgetNs * GOVERNOR_STEP_UP_PERCENT) {
+        governor->underBudget++;
+        governor->overBudget = 0;
+    } else {
+        governor->overBudget = 0;
+        governor->underBudget = 0;
+    }
+
+    if(governor->overBudget >= GOVERNOR_STEP_DOWN_FRAMES && governor->level < QUALITY_LEVELS - 1) {
+        governor->level++;
+        governor->overBudget = 0;
+        // the new level is cheaper, give the average a head start so it can see it
+        governor->averageNs = governor->budgetNs;
+        return true;
+    }
+    if(governor->underBudget >= GOVERNOR_STEP_UP_FRAMES && governor->level > QUALITY_FULL) {
+        governor->level--;
+        governor->underBudget = 0;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,135 @@
+/**
+    RenderPool.cpp
+
+    Description:
+    Persistent worker pool for the panel render loop, see RenderPool.h.
+    Each frame the calling thread publishes the job and bumps a generation counter, the workers
+    wake up, render their slice and count down `pending`; the last one to finish wakes the caller.
+ */
+
+#include "RenderPool.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+struct render_pool_t {
+    std::thread* workers;
+    int nWorkers;
+    int minItems;
+    std::mutex lock;
+    std::condition_variable start;  // signalled when a new job is published or the pool is stopping
+    std::condition_variable done;   // signalled when the last worker finished its slice
+    unsigned int generation;        // incremented once per job
+    int pending;                    // number of workers still busy with the current job
+    bool stopping;
+    render_range_fn fn;
+    void* arg;
+    int nItems;
+};
+
+/** Work out the slice of a job that belongs to a given thread, thread 0 is the caller */
+static void sliceRange(int nItems, int nThreads, int thread, int* begin, int* end)
+{
+    *begin = (int)((long)nItems * thread / nThreads);
+    *end = (int)((long)nItems * (thread + 1) / nThreads);
+}
+
+static void workerLoop(render_pool_t* pool, int thread)
+{
+    unsigned int seen = 0;
+    std::unique_lock<std::mutex> guard(pool->lock);
+    while(true) {
+        while(!pool->stopping && pool->generation == seen) {
+            pool->start.wait(guard);
+        }
+        if(pool->stopping) {
+            return;
+        }
+        seen = pool->generation;
+        render_range_fn fn = pool->fn;
+        void* arg = pool->arg;
+        int begin;
+        int end;
+        sliceRange(pool->nItems, pool->nWorkers + 1, thread, &begin, &end);
+        guard.unlock();
+
+        if(begin < end) {
+            fn(begin, end, arg);
+        }
+
+        guard.lock();
+        pool->pending--;
+        if(pool->pending == 0) {
+            pool->done.notify_one();
+        }
+    }
+}
+
+render_pool_t* renderPoolCreate(int nWorkers, int minItems)
+{
+    if(nWorkers < 1) {
+        return NULL;
+    }
+    render_pool_t* pool = new render_pool_t;
+    pool->nWorkers = nWorkers;
+    pool->minItems = minItems;
+    pool->generation = 0;
+    pool->pending = 0;
+    pool->stopping = false;
+    pool->fn = NULL;
+    pool->arg = NULL;
+    pool->nItems = 0;
+    pool->workers = new std::thread[nWorkers];
+    for(int i = 0; i < nWorkers; i++) {
+        pool->workers[i] = std::thread(workerLoop, pool, i + 1);
+    }
+    return pool;
+}
+
+void renderPoolRun(render_pool_t* pool, render_range_fn fn, void* arg, int nItems)
+{
+    if(pool == NULL || nItems < pool->minItems) {
+        fn(0, nItems, arg);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(pool->lock);
+        pool->fn = fn;
+        pool->arg = arg;
+        pool->nItems = nItems;
+        pool->pending = pool->nWorkers;
+        pool->generation++;
+    }
+    pool->start.notify_all();
+
+    // the calling thread renders the first slice while the workers do the rest
+    int begin;
+    int end;
+    sliceRange(nItems, pool->nWorkers + 1, 0, &begin, &end);
+    if(begin < end) {
+        fn(begin, end, arg);
+    }
+
+    std::unique_lock<std::mutex> guard(pool->lock);
+    while(pool->pending > 0) {
+        pool->done.wait(guard);
+    }
+}
+
+void renderPoolDestroy(render_pool_t* pool)
+{
+    if(pool == NULL) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(pool->lock);
+        pool->stopping = true;
+    }
+    pool->start.notify_all();
+    for(int i = 0; i < pool->nWorkers; i++) {
+        pool->workers[i].join();
+    }
+    delete [] pool->workers;
+    delete pool;
+}
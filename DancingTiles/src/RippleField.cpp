@@ -0,0 +1,160 @@
+/**
+    RippleField.cpp
+
+    Description:
+    The damped wave equation on the panel graph and the ripple rings evaluated from the hop distances, see
+    RippleField.h.
+ */
+
+#include "RippleField.h"
+#include <stddef.h>
+#include <math.h>
+#include <algorithm>
+
+void rippleInit(ripple_field_t* field, int nPanels, const int* adjacencyStart, const int* adjacency, float speed, float damping)
+{
+    field->nPanels = nPanels;
+    field->adjacencyStart = adjacencyStart;
+    field->adjacency = adjacency;
+    field->now = new ripple_colour_t[nPanels]();
+    field->before = new ripple_colour_t[nPanels]();
+    field->keep = new float[nPanels];
+
+    // the graph Laplacian of a panel with n neighbours has eigenvalues up to 2n, and the explicit step only
+    // stays bounded while speed^2 times that is at most 4
+    int maxDegree = 0;
+    for(int p = 0; p < nPanels; p++) {
+        maxDegree = std::max(maxDegree, adjacencyStart[p + 1] - adjacencyStart[p]);
+    }
+    float pull = speed * speed;
+    if(maxDegree > 0) {
+        pull = std::min(pull, 2.0f / maxDegree);
+    }
+    for(int p = 0; p < nPanels; p++) {
+        field->keep[p] = 2.0 - (adjacencyStart[p + 1] - adjacencyStart[p]) * pull;
+    }
+    field->pull = pull;
+    field->damping = damping;
+}
+
+void rippleLaunch(ripple_field_t* field, int panel, float R, float G, float B)
+{
+    ripple_colour_t kick = {R, G, B, 0};
+    field->now[panel] += kick;
+}
+
+void rippleStepRange(ripple_field_t* field, int begin, int end)
+{
+    const int* adjacencyStart = field->adjacencyStart;
+    const int* adjacency = field->adjacency;
+    const ripple_colour_t* now = field->now;
+    ripple_colour_t* before = field->before;
+    for(int p = begin; p < end; p++) {
+        ripple_colour_t neighbours = {0, 0, 0, 0};
+        for(int i = adjacencyStart[p]; i < adjacencyStart[p + 1]; i++) {
+            neighbours += now[adjacency[i]];
+        }
+        before[p] = (now[p] * field->keep[p] + neighbours * field->pull - before[p]) * field->damping;
+    }
+}
+
+void rippleSwap(ripple_field_t* field)
+{
+    std::swap(field->now, field->before);
+}
+
+void rippleFree(ripple_field_t* field)
+{
+    delete [] field->now;
+    delete [] field->before;
+    delete [] field->keep;
+    field->now = NULL;
+    field->before = NULL;
+    field->keep = NULL;
+}
+
+/** Set the ring of a ripple for its age */
+static void placeRing(const ripple_rings_t* rings, ripple_ring_t* ring)
+{
+    ring->radius = rings->speed * ring->age;
+    ring->crest = ring->colour * (float)pow(rings->damping, ring->age);
+}
+
+void rippleRingsInit(ripple_rings_t* rings, const layout_cache_t* layoutCache, int capacity, float speed, float damping, float width)
+{
+    rings->nPanels = layoutCache->view.nPanels;
+    rings->layoutCache = layoutCache;
+    rings->rings = new ripple_ring_t[capacity > 0 ? capacity : 1];
+    rings->capacity = std::max(capacity, 1);
+    rings->count = 0;
+    rings->now = new ripple_colour_t[rings->nPanels]();
+    rings->speed = speed;
+    rings->damping = damping;
+    rings->width = width;
+    rings->maxAge = damping < 1 ? (int)ceil(log(RIPPLE_RINGS_CUTOFF) / log(damping)) : 0;
+}
+
+void rippleRingsLaunch(ripple_rings_t* rings, int panel, float R, float G, float B)
+{
+    int i = rings->count;
+    if(i < rings->capacity) {
+        rings->count++;
+    } else {
+        // full, the oldest ripple makes way
+        i = 0;
+        for(int r = 1; r < rings->count; r++) {
+            if(rings->rings[r].age > rings->rings[i].age) {
+                i = r;
+            }
+        }
+    }
+    ripple_ring_t* ring = &rings->rings[i];
+    ripple_colour_t colour = {R, G, B, 0};
+    ring->panel = panel;
+    ring->age = 0;
+    ring->colour = colour;
+    placeRing(rings, ring);
+}
+
+void rippleRingsEvaluateRange(ripple_rings_t* rings, int begin, int end)
+{
+    const layout_cache_t* layoutCache = rings->layoutCache;
+    const ripple_ring_t* ring = rings->rings;
+    const float inverseWidth = 1.0 / rings->width;
+    const ripple_colour_t rest = {0, 0, 0, 0};
+    for(int p = begin; p < end; p++) {
+        rings->now[p] = rest;
+    }
+    // ripple by ripple, so the rows of the table a ripple reads stay in the cache across the panels
+    for(int r = 0; r < rings->count; r++) {
+        for(int p = begin; p < end; p++) {
+            int hops = layoutCacheHops(layoutCache, p, ring[r].panel);
+            float off = fabsf(hops - ring[r].radius) * inverseWidth;
+            if(off < 1.0f && hops != LAYOUT_CACHE_HOPS_UNREACHABLE) {
+                rings->now[p] += ring[r].crest * (1.0f - off);
+            }
+        }
+    }
+}
+
+void rippleRingsAdvance(ripple_rings_t* rings)
+{
+    int r = 0;
+    while(r < rings->count) {
+        ripple_ring_t* ring = &rings->rings[r];
+        if(++ring->age > rings->maxAge) {
+            *ring = rings->rings[--rings->count];
+            continue;
+        }
+        placeRing(rings, ring);
+        r++;
+    }
+}
+
+void rippleRingsFree(ripple_rings_t* rings)
+{
+    delete [] rings->rings;
+    delete [] rings->now;
+    rings->rings = NULL;
+    rings->now = NULL;
+}
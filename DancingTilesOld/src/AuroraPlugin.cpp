@@ -57,6 +57,7 @@ extern "C" {
 #define BASE_COLOUR_B 0
 #define ADJACENT_PANEL_DISTANCE 86.599995   // hard coded distance between adjacent panels; this ideally should be autodetected
 #define TRANSITION_TIME 1  // the transition time to send to panels; set to 100ms currently
+#define LOG_LAYOUT false // print every palette colour and panel position on start-up
 #define MINIMUM_INTENSITY 0.2  // the minimum intensity of a source
 #define TRIGGER_THRESHOLD 0.5 // used to calculate whether to add a source
 #define SPAWN_AMOUNT 1
@@ -125,17 +126,21 @@ void initPlugin() {
         nColours = MAX_PALETTE_COLOURS;
     }
 
-    for (int i = 0; i < nColours; i++) {
-        PRINTLOG("   %d %d %d\n", paletteColours[i].R, paletteColours[i].G, paletteColours[i].B);
+    if(LOG_LAYOUT) {
+        for (int i = 0; i < nColours; i++) {
+            PRINTLOG("   %d %d %d\n", paletteColours[i].R, paletteColours[i].G, paletteColours[i].B);
+        }
     }
 
     layoutData = getLayoutData(); // grab the layout data and store a pointer to it for later use
 
 
-    PRINTLOG("The layout has %d panels:\n", layoutData->nPanels);
-    for (int i = 0; i < layoutData->nPanels; i++) {
-        PRINTLOG("   Id: %d   X, Y: %lf, %lf\n", layoutData->panels[i].panelId,
-               layoutData->panels[i].shape->getCentroid().x, layoutData->panels[i].shape->getCentroid().y);
+    PRINTLOG("The layout has %d panels\n", layoutData->nPanels);
+    if(LOG_LAYOUT) {
+        for (int i = 0; i < layoutData->nPanels; i++) {
+            PRINTLOG("   Id: %d   X, Y: %lf, %lf\n", layoutData->panels[i].panelId,
+                   layoutData->panels[i].shape->getCentroid().x, layoutData->panels[i].shape->getCentroid().y);
+        }
     }
 
 
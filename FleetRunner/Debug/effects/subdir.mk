@@ -0,0 +1,224 @@
+################################################################################
+# Automatically-generated file. Do not edit!
+################################################################################
+
+# Add inputs and outputs from these tool invocations to the build variables 
+CPP_SRCS += \
+../../DancingTiles/src/DancingTiles.cpp \
+../../DancingTiles/src/LayoutCache.cpp \
+../../DancingTiles/src/DiffusionField.cpp \
+../../DancingTiles/src/RippleField.cpp \
+../../DancingTiles/src/RenderPool.cpp \
+../../DancingTiles/src/QualityGovernor.cpp \
+../../DancingTiles/src/BeatCalibration.cpp \
+../../DancingTiles/src/DetectorState.cpp \
+../../DancingTiles/src/BandMapper.cpp \
+../../DancingTiles/src/PanelOccupancy.cpp \
+../../DancingTiles/src/Prng.cpp \
+../../GameOfLife/src/GameOfLife.cpp \
+../../GameOfLife/src/LifeGrid.cpp \
+../../GameOfLife/src/LifeHistory.cpp \
+../../GameOfLife/src/LifeHashlife.cpp \
+../../GameOfLife/src/PanelAutomaton.cpp \
+../../MovingLightSource/src/MovingLightSource.cpp \
+../../MovingLightSource/src/SplatRenderer.cpp \
+../../MovingLightSource/src/ParticleSystem.cpp \
+../../ReactionDiffusion/src/ReactionDiffusion.cpp \
+../../ReactionDiffusion/src/GrayScott.cpp 
+
+OBJS += \
+./effects/DancingTiles.o \
+./effects/LayoutCache.o \
+./effects/DiffusionField.o \
+./effects/RippleField.o \
+./effects/RenderPool.o \
+./effects/QualityGovernor.o \
+./effects/BeatCalibration.o \
+./effects/DetectorState.o \
+./effects/BandMapper.o \
+./effects/PanelOccupancy.o \
+./effects/Prng.o \
+./effects/GameOfLife.o \
+./effects/LifeGrid.o \
+./effects/LifeHistory.o \
+./effects/LifeHashlife.o \
+./effects/PanelAutomaton.o \
+./effects/MovingLightSource.o \
+./effects/SplatRenderer.o \
+./effects/ParticleSystem.o \
+./effects/ReactionDiffusion.o \
+./effects/GrayScott.o 
+
+CPP_DEPS += \
+./effects/DancingTiles.d \
+./effects/LayoutCache.d \
+./effects/DiffusionField.d \
+./effects/RippleField.d \
+./effects/RenderPool.d \
+./effects/QualityGovernor.d \
+./effects/BeatCalibration.d \
+./effects/DetectorState.d \
+./effects/BandMapper.d \
+./effects/PanelOccupancy.d \
+./effects/Prng.d \
+./effects/GameOfLife.d \
+./effects/LifeGrid.d \
+./effects/LifeHistory.d \
+./effects/LifeHashlife.d \
+./effects/PanelAutomaton.d \
+./effects/MovingLightSource.d \
+./effects/SplatRenderer.d \
+./effects/ParticleSystem.d \
+./effects/ReactionDiffusion.d \
+./effects/GrayScott.d 
+
+
+# Each subdirectory must supply rules for building sources it contributes
+effects/DancingTiles.o: ../../DancingTiles/src/DancingTiles.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/LayoutCache.o: ../../DancingTiles/src/LayoutCache.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/DiffusionField.o: ../../DancingTiles/src/DiffusionField.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/RippleField.o: ../../DancingTiles/src/RippleField.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/RenderPool.o: ../../DancingTiles/src/RenderPool.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/QualityGovernor.o: ../../DancingTiles/src/QualityGovernor.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/BeatCalibration.o: ../../DancingTiles/src/BeatCalibration.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/DetectorState.o: ../../DancingTiles/src/DetectorState.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/BandMapper.o: ../../DancingTiles/src/BandMapper.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/PanelOccupancy.o: ../../DancingTiles/src/PanelOccupancy.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/Prng.o: ../../DancingTiles/src/Prng.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/GameOfLife.o: ../../GameOfLife/src/GameOfLife.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/LifeGrid.o: ../../GameOfLife/src/LifeGrid.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/LifeHistory.o: ../../GameOfLife/src/LifeHistory.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/LifeHashlife.o: ../../GameOfLife/src/LifeHashlife.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/PanelAutomaton.o: ../../GameOfLife/src/PanelAutomaton.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/MovingLightSource.o: ../../MovingLightSource/src/MovingLightSource.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/SplatRenderer.o: ../../MovingLightSource/src/SplatRenderer.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/ParticleSystem.o: ../../MovingLightSource/src/ParticleSystem.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/ReactionDiffusion.o: ../../ReactionDiffusion/src/ReactionDiffusion.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+effects/GrayScott.o: ../../ReactionDiffusion/src/GrayScott.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+
@@ -0,0 +1,33 @@
+################################################################################
+# Automatically-generated file. Do not edit!
+################################################################################
+
+# Add inputs and outputs from these tool invocations to the build variables 
+CPP_SRCS += \
+../src/FleetRunner.cpp \
+../src/FrameTimeHistogram.cpp \
+../src/Installation.cpp \
+../src/WorkStealingPool.cpp 
+
+OBJS += \
+./src/FleetRunner.o \
+./src/FrameTimeHistogram.o \
+./src/Installation.o \
+./src/WorkStealingPool.o 
+
+CPP_DEPS += \
+./src/FleetRunner.d \
+./src/FrameTimeHistogram.d \
+./src/Installation.d \
+./src/WorkStealingPool.d 
+
+
+# Each subdirectory must supply rules for building sources it contributes
+src/%.o: ../src/%.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -I../../DancingTiles/inc -I../../GameOfLife/inc -I../../MovingLightSource/inc -I../../ReactionDiffusion/inc -O2 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+
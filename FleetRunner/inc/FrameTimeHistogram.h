@@ -0,0 +1,51 @@
+/**
+    FrameTimeHistogram.h
+
+    Description:
+    Fixed size log-linear histogram of frame times in nanoseconds. Every power of two is split into
+    HISTOGRAM_SUB_BUCKETS equal buckets, so a percentile read back from it is within 1 / HISTOGRAM_SUB_BUCKETS
+    of the true value whatever the spread of the samples. Adding a sample is a few shifts and an increment,
+    and histograms filled on different threads are combined with histogramMerge().
+ */
+
+#ifndef INC_FRAMETIMEHISTOGRAM_H_
+#define INC_FRAMETIMEHISTOGRAM_H_
+
+#include <stdint.h>
+
+#define HISTOGRAM_SUB_BUCKET_BITS 4
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_MAX_BITS 40 // samples of 2^40 ns (about 18 minutes) and above land in the last bucket
+#define HISTOGRAM_BUCKETS ((HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKETS)
+
+typedef struct {
+    uint32_t counts[HISTOGRAM_BUCKETS];
+    uint64_t count;
+    uint64_t total;     // sum of all samples, for the mean
+    uint64_t min;
+    uint64_t max;
+} frame_time_histogram_t;
+
+/**
+ * @description: empty a histogram
+ */
+void histogramReset(frame_time_histogram_t* histogram);
+
+/**
+ * @description: record one sample
+ */
+void histogramAdd(frame_time_histogram_t* histogram, uint64_t ns);
+
+/**
+ * @description: add all the samples of src to dst
+ */
+void histogramMerge(frame_time_histogram_t* dst, const frame_time_histogram_t* src);
+
+/**
+ * @description: the value below which a fraction p of the samples lie
+ * @param p: between 0 and 1, e.g. 0.99 for the 99th percentile
+ * @return: the upper edge of the bucket holding that sample, 0 for an empty histogram
+ */
+uint64_t histogramPercentile(const frame_time_histogram_t* histogram, double p);
+
+#endif /* INC_FRAMETIMEHISTOGRAM_H_ */
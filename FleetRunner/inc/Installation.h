@@ -0,0 +1,58 @@
+/**
+    Installation.h
+
+    Description:
+    A virtual installation for the fleet runner: a panel layout, a colour palette, an audio trace to play
+    to the effect and the effect to run on it. Installations are listed in an inventory file, one per line:
+
+        # name      effect          layout              palette             audio           seed    frames
+        lobby       dancingtiles    layouts/lobby.json  palettes/warm.json  traces/lobby.txt 1      6000
+        stress      gameoflife      random:400          default             random          7       2000
+
+    layout:  a layout as returned by the Aurora OpenAPI (the "positionData" list of panelId/x/y/o),
+             or random:N for a randomly grown layout of N triangles
+    palette: a palette file in the format of the plugin projects' palette file (hue/saturation/brightness),
+             or default for seven evenly spread hues
+    audio:   a text file with the fft bins of one frame per line, played in a loop,
+             or random for a synthetic trace with periodic peaks in every bin
+    seed:    seeds the random layout and audio and the effect's own random numbers, so a run replays exactly
+
+    Relative paths are taken relative to the inventory file.
+ */
+
+#ifndef INC_INSTALLATION_H_
+#define INC_INSTALLATION_H_
+
+#include <stdint.h>
+#include <vector>
+#include "ColorUtils.h"
+#include "LayoutProcessingUtils.h"
+
+#define INSTALLATION_NAME_LENGTH 64
+
+typedef struct {
+    char name[INSTALLATION_NAME_LENGTH];
+    char effect[INSTALLATION_NAME_LENGTH];
+    LayoutData* layout;
+    RGB_t* palette;
+    int nColors;
+    uint8_t* trace;         // traceFrames rows of traceBins fft bins
+    int traceFrames;
+    int traceBins;
+    unsigned int seed;
+    int frames;             // number of frames to simulate
+} installation_t;
+
+/**
+ * @description: read an inventory file and load every installation listed in it
+ * @param installations: the loaded installations are appended here, free them with installationFree()
+ * @return: true if every line loaded, false after printing the first error to stderr
+ */
+bool loadInventory(const char* path, std::vector<installation_t*>* installations);
+
+/**
+ * @description: free an installation and everything it owns. NULL is ignored.
+ */
+void installationFree(installation_t* installation);
+
+#endif /* INC_INSTALLATION_H_ */
@@ -0,0 +1,35 @@
+/**
+    WorkStealingPool.h
+
+    Description:
+    Runs a fixed set of independent tasks on a number of threads. The tasks are dealt out round robin to a
+    deque per worker up front. A worker takes its own tasks from the front of its deque, and once that runs dry
+    it steals from the back of the other workers' deques, so a worker that drew a few long installations does
+    not hold up the run while the others sit idle. Callers that know the rough cost of each task should
+    hand them in longest first.
+ */
+
+#ifndef INC_WORKSTEALINGPOOL_H_
+#define INC_WORKSTEALINGPOOL_H_
+
+/**
+ * @description: callback that runs one task. Called concurrently for different tasks.
+ * @param task: index of the task in [0, nTasks)
+ * @param worker: index of the calling worker in [0, nWorkers), e.g. to pick per worker scratch space
+ */
+typedef void (*task_fn)(int task, int worker, void* arg);
+
+typedef struct {
+    int executed;   // tasks run by this worker
+    int stolen;     // how many of those it took from another worker's deque
+} worker_stats_t;
+
+/**
+ * @description: run tasks 0 to nTasks - 1 on nWorkers threads and return once all of them are done.
+ * The calling thread is worker 0.
+ * @param order: the order the tasks are dealt out in, NULL for 0 to nTasks - 1
+ * @param stats: NULL or room for nWorkers entries, filled with what each worker did
+ */
+void workStealingRun(int nWorkers, int nTasks, const int* order, task_fn fn, void* arg, worker_stats_t* stats);
+
+#endif /* INC_WORKSTEALINGPOOL_H_ */
@@ -0,0 +1,348 @@
+/**
+    FleetRunner.cpp
+
+    Description:
+    Simulates a whole inventory of installations at once to validate a release against every site rather
+    than one layout at a time. Each installation gets its own instance of its effect, which is fed the
+    installation's audio trace frame by frame, exactly as getPluginFrame() would drive it on the device.
+    Installations run in parallel on a work stealing pool, every frame is timed and the frame times are
+    collected in a histogram per installation and one for the whole fleet.
+
+    usage: FleetRunner <inventory> [-j workers] [-n frames]
+        -j: number of threads, defaults to the number of cores
+        -n: simulate this many frames on every installation instead of the count in the inventory
+    See Installation.h for the inventory format.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "Installation.h"
+#include "WorkStealingPool.h"
+#include "FrameTimeHistogram.h"
+#include "DancingTiles.h"
+#include "GameOfLife.h"
+#include "MovingLightSource.h"
+#include "ReactionDiffusion.h"
+
+#define DEFAULT_TEMPO 120 // tempo reported to the effects, the traces only carry fft bins
+
+// The effects the runner knows about, each wrapped to the same signature
+typedef struct {
+    const char* name;
+    void* (*create)(LayoutData* layout, RGB_t* palette, int nColors, uint64_t seed);
+    int (*fftBins)(void* instance);
+    void (*frame)(void* instance, const frame_uniforms_t* uniforms, Frame_t* frames, int* nFrames);
+    void (*destroy)(void* instance);
+} effect_t;
+
+typedef struct {
+    const effect_t* effect;
+    frame_time_histogram_t histogram;
+    uint64_t setupNs;       // creating the instance, including building its layout data
+    uint64_t emitted;       // frames sent to panels over the whole run
+} installation_result_t;
+
+typedef struct {
+    installation_t** installations;
+    installation_result_t* results;
+} fleet_run_t;
+
+/**
+  * The DancingTiles configuration of the fleet. The quality governor is off so every installation renders at full
+  * quality whatever the load on the machine, otherwise the histograms of two runs would mix quality levels.
+  */
+static void fleetDancingTilesConfig(dancing_tiles_config_t* config, uint64_t seed, dancing_tiles_mode_t mode)
+{
+    dancingTilesDefaultConfig(config);
+    config->renderThreads = 0; // the fleet is parallel across installations already
+    config->layoutCachePath = NULL;
+    config->frameBudgetMs = 0;
+    config->randomSeed = seed;
+    config->mode = mode;
+}
+
+static void* dancingTilesEffectCreate(LayoutData* layout, RGB_t* palette, int nColors, uint64_t seed)
+{
+    dancing_tiles_config_t config;
+    fleetDancingTilesConfig(&config, seed, DANCING_TILES_SOURCES);
+    return dancingTilesCreate(layout, palette, nColors, &config);
+}
+
+static void* diffusionEffectCreate(LayoutData* layout, RGB_t* palette, int nColors, uint64_t seed)
+{
+    dancing_tiles_config_t config;
+    fleetDancingTilesConfig(&config, seed, DANCING_TILES_DIFFUSION);
+    return dancingTilesCreate(layout, palette, nColors, &config);
+}
+
+static void* ripplesEffectCreate(LayoutData* layout, RGB_t* palette, int nColors, uint64_t seed)
+{
+    dancing_tiles_config_t config;
+    fleetDancingTilesConfig(&config, seed, DANCING_TILES_RIPPLES);
+    config.rippleHops = true;
+    return dancingTilesCreate(layout, palette, nColors, &config);
+}
+
+static int dancingTilesEffectFftBins(void* instance)
+{
+    return dancingTilesFftBins((dancing_tiles_t*)instance);
+}
+
+static void dancingTilesEffectFrame(void* instance, const frame_uniforms_t* uniforms, Frame_t* frames, int* nFrames)
+{
+    frame_uniforms_t derived = *uniforms;
+    dancingTilesDeriveUniforms((dancing_tiles_t*)instance, &derived);
+    dancingTilesFrame((dancing_tiles_t*)instance, &derived, frames, nFrames);
+}
+
+static void dancingTilesEffectDestroy(void* instance)
+{
+    dancingTilesDestroy((dancing_tiles_t*)instance);
+}
+
+static void* gameOfLifeEffectCreate(LayoutData* layout, RGB_t* palette, int nColors, uint64_t seed)
+{
+    return gameOfLifeCreate(layout, palette, nColors, seed);
+}
+
+static void* briansBrainEffectCreate(LayoutData* layout, RGB_t* palette, int nColors, uint64_t seed)
+{
+    game_of_life_t* instance = gameOfLifeCreate(layout, palette, nColors, seed);
+    gameOfLifeSetPanelRule(instance, "BriansBrain");
+    return instance;
+}
+
+static int gameOfLifeEffectFftBins(void* instance)
+{
+    return gameOfLifeFftBins((game_of_life_t*)instance);
+}
+
+static void gameOfLifeEffectFrame(void* instance, const frame_uniforms_t* uniforms, Frame_t* frames, int* nFrames)
+{
+    gameOfLifeFrame((game_of_life_t*)instance, uniforms->fftBins, frames, nFrames);
+}
+
+static void gameOfLifeEffectDestroy(void* instance)
+{
+    gameOfLifeDestroy((game_of_life_t*)instance);
+}
+
+static void* movingLightSourceEffectCreate(LayoutData* layout, RGB_t* palette, int nColors, uint64_t seed)
+{
+    return movingLightSourceCreate(layout, palette, nColors, seed);
+}
+
+static int movingLightSourceEffectFftBins(void* instance)
+{
+    return movingLightSourceFftBins((moving_light_source_t*)instance);
+}
+
+static void movingLightSourceEffectFrame(void* instance, const frame_uniforms_t* uniforms, Frame_t* frames, int* nFrames)
+{
+    movingLightSourceFrame((moving_light_source_t*)instance, uniforms->fftBins, frames, nFrames);
+}
+
+static void movingLightSourceEffectDestroy(void* instance)
+{
+    movingLightSourceDestroy((moving_light_source_t*)instance);
+}
+
+static void* reactionDiffusionEffectCreate(LayoutData* layout, RGB_t* palette, int nColors, uint64_t seed)
+{
+    return reactionDiffusionCreate(layout, palette, nColors, seed);
+}
+
+static int reactionDiffusionEffectFftBins(void* instance)
+{
+    return reactionDiffusionFftBins((reaction_diffusion_t*)instance);
+}
+
+static void reactionDiffusionEffectFrame(void* instance, const frame_uniforms_t* uniforms, Frame_t* frames, int* nFrames)
+{
+    reactionDiffusionFrame((reaction_diffusion_t*)instance, uniforms->fftBins, frames, nFrames);
+}
+
+static void reactionDiffusionEffectDestroy(void* instance)
+{
+    reactionDiffusionDestroy((reaction_diffusion_t*)instance);
+}
+
+static const effect_t effects[] = {
+    { "dancingtiles", dancingTilesEffectCreate, dancingTilesEffectFftBins, dancingTilesEffectFrame, dancingTilesEffectDestroy },
+    { "diffusion", diffusionEffectCreate, dancingTilesEffectFftBins, dancingTilesEffectFrame, dancingTilesEffectDestroy },
+    { "ripples", ripplesEffectCreate, dancingTilesEffectFftBins, dancingTilesEffectFrame, dancingTilesEffectDestroy },
+    { "gameoflife", gameOfLifeEffectCreate, gameOfLifeEffectFftBins, gameOfLifeEffectFrame, gameOfLifeEffectDestroy },
+    { "briansbrain", briansBrainEffectCreate, gameOfLifeEffectFftBins, gameOfLifeEffectFrame, gameOfLifeEffectDestroy },
+    { "movinglightsource", movingLightSourceEffectCreate, movingLightSourceEffectFftBins, movingLightSourceEffectFrame, movingLightSourceEffectDestroy },
+    { "reactiondiffusion", reactionDiffusionEffectCreate, reactionDiffusionEffectFftBins, reactionDiffusionEffectFrame, reactionDiffusionEffectDestroy },
+};
+
+static const effect_t* findEffect(const char* name)
+{
+    for(size_t i = 0; i < sizeof(effects) / sizeof(effects[0]); i++) {
+        if(strcmp(effects[i].name, name) == 0) {
+            return &effects[i];
+        }
+    }
+    return NULL;
+}
+
+static uint64_t elapsedNs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+/** Runs one installation from start to finish, called from the work stealing pool */
+static void runInstallation(int task, int worker, void* arg)
+{
+    fleet_run_t* run = (fleet_run_t*)arg;
+    installation_t* installation = run->installations[task];
+    installation_result_t* result = &run->results[task];
+    const effect_t* effect = result->effect;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    void* instance = effect->create(installation->layout, installation->palette, installation->nColors, installation->seed);
+    result->setupNs = elapsedNs(start, std::chrono::steady_clock::now());
+
+    int nBins = effect->fftBins(instance);
+    int nCopied = std::min(nBins, installation->traceBins);
+    uint8_t* bins = new uint8_t[nBins > 0 ? nBins : 1]();
+    Frame_t* frames = new Frame_t[installation->layout->nPanels];
+    histogramReset(&result->histogram);
+    result->emitted = 0;
+
+    for(int f = 0; f < installation->frames; f++) {
+        // what sampleUniforms() would have read from the host on the device
+        const uint8_t* row = installation->trace + (f % installation->traceFrames) * installation->traceBins;
+        memcpy(bins, row, nCopied);
+        frame_uniforms_t uniforms;
+        uniforms.fftBins = bins;
+        uniforms.tempo = DEFAULT_TEMPO;
+
+        int nFrames = 0;
+        std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+        effect->frame(instance, &uniforms, frames, &nFrames);
+        histogramAdd(&result->histogram, elapsedNs(frameStart, std::chrono::steady_clock::now()));
+        result->emitted += nFrames;
+    }
+
+    effect->destroy(instance);
+    delete [] frames;
+    delete [] bins;
+}
+
+static void printRow(const char* name, const char* effect, int nPanels, const frame_time_histogram_t* histogram, double setupMs,
+                     uint64_t emitted)
+{
+    double mean = histogram->count > 0 ? (double)histogram->total / histogram->count : 0;
+    printf("%-24s %-18s %7d %9llu %10llu %9.2f %9.1f %9.1f %9.1f %9.1f %9.1f\n", name, effect, nPanels,
+           (unsigned long long)histogram->count, (unsigned long long)emitted, setupMs, mean / 1000.0,
+           histogramPercentile(histogram, 0.50) / 1000.0, histogramPercentile(histogram, 0.95) / 1000.0,
+           histogramPercentile(histogram, 0.99) / 1000.0, histogram->max / 1000.0);
+}
+
+int main(int argc, char** argv)
+{
+    const char* inventory = NULL;
+    int nWorkers = std::thread::hardware_concurrency();
+    int framesOverride = 0;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            nWorkers = atoi(argv[++i]);
+        } else if(strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            framesOverride = atoi(argv[++i]);
+        } else if(inventory == NULL) {
+            inventory = argv[i];
+        } else {
+            inventory = NULL;
+            break;
+        }
+    }
+    if(inventory == NULL) {
+        fprintf(stderr, "usage: %s <inventory> [-j workers] [-n frames]\n", argv[0]);
+        return 2;
+    }
+    if(nWorkers < 1) {
+        nWorkers = 1;
+    }
+
+    std::vector<installation_t*> installations;
+    if(!loadInventory(inventory, &installations)) {
+        for(size_t i = 0; i < installations.size(); i++) {
+            installationFree(installations[i]);
+        }
+        return 1;
+    }
+    int nInstallations = installations.size();
+
+    fleet_run_t run;
+    run.installations = installations.data();
+    run.results = new installation_result_t[nInstallations];
+    bool known = true;
+    for(int i = 0; i < nInstallations; i++) {
+        if(framesOverride > 0) {
+            installations[i]->frames = framesOverride;
+        }
+        run.results[i].effect = findEffect(installations[i]->effect);
+        if(run.results[i].effect == NULL) {
+            fprintf(stderr, "installation %s: unknown effect %s\n", installations[i]->name, installations[i]->effect);
+            known = false;
+        }
+    }
+
+    // deal the biggest installations out first so the long ones do not end up last on a single worker
+    std::vector<int> order(nInstallations);
+    for(int i = 0; i < nInstallations; i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&installations](int a, int b) {
+        return (long)installations[a]->layout->nPanels * installations[a]->frames >
+               (long)installations[b]->layout->nPanels * installations[b]->frames;
+    });
+
+    int status = 1;
+    if(known) {
+        worker_stats_t* stats = new worker_stats_t[nWorkers];
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        workStealingRun(nWorkers, nInstallations, order.data(), runInstallation, &run, stats);
+        double wallSeconds = elapsedNs(start, std::chrono::steady_clock::now()) / 1e9;
+
+        printf("%-24s %-18s %7s %9s %10s %9s %9s %9s %9s %9s %9s\n", "installation", "effect", "panels", "frames",
+               "emitted", "setup ms", "mean us", "p50 us", "p95 us", "p99 us", "max us");
+        frame_time_histogram_t fleet;
+        histogramReset(&fleet);
+        uint64_t fleetPanels = 0;
+        double fleetSetupMs = 0;
+        uint64_t fleetEmitted = 0;
+        for(int i = 0; i < nInstallations; i++) {
+            printRow(installations[i]->name, installations[i]->effect, installations[i]->layout->nPanels,
+                     &run.results[i].histogram, run.results[i].setupNs / 1e6, run.results[i].emitted);
+            histogramMerge(&fleet, &run.results[i].histogram);
+            fleetPanels += installations[i]->layout->nPanels;
+            fleetSetupMs += run.results[i].setupNs / 1e6;
+            fleetEmitted += run.results[i].emitted;
+        }
+        printRow("fleet", "", (int)fleetPanels, &fleet, fleetSetupMs, fleetEmitted);
+
+        int stolen = 0;
+        for(int i = 0; i < nWorkers; i++) {
+            stolen += stats[i].stolen;
+        }
+        printf("\n%d installations, %llu frames in %.2f s on %d workers (%.0f frames/s, %d installations stolen)\n",
+               nInstallations, (unsigned long long)fleet.count, wallSeconds, nWorkers,
+               wallSeconds > 0 ? fleet.count / wallSeconds : 0, stolen);
+        delete [] stats;
+        status = 0;
+    }
+
+    delete [] run.results;
+    for(int i = 0; i < nInstallations; i++) {
+        installationFree(installations[i]);
+    }
+    return status;
+}
@@ -0,0 +1,94 @@
+/**
+    FrameTimeHistogram.cpp
+
+    Description:
+    Log-linear frame time histogram, see FrameTimeHistogram.h.
+    Values below HISTOGRAM_SUB_BUCKETS get a bucket each. Above that, a value whose highest set bit is
+    bit m lands in octave m - HISTOGRAM_SUB_BUCKET_BITS, and the HISTOGRAM_SUB_BUCKET_BITS bits below
+    the highest one pick the bucket inside the octave.
+ */
+
+#include "FrameTimeHistogram.h"
+#include <string.h>
+
+static int bucketIndex(uint64_t ns)
+{
+    if(ns < HISTOGRAM_SUB_BUCKETS) {
+        return (int)ns;
+    }
+    int msb = 63 - __builtin_clzll(ns);
+    if(msb >= HISTOGRAM_MAX_BITS) {
+        return HISTOGRAM_BUCKETS - 1;
+    }
+    int shift = msb - HISTOGRAM_SUB_BUCKET_BITS;
+    return (shift + 1) * HISTOGRAM_SUB_BUCKETS + (int)((ns >> shift) - HISTOGRAM_SUB_BUCKETS);
+}
+
+/** The largest value that lands in a bucket */
+static uint64_t bucketUpperEdge(int index)
+{
+    if(index < HISTOGRAM_SUB_BUCKETS) {
+        return index;
+    }
+    int shift = index / HISTOGRAM_SUB_BUCKETS - 1;
+    uint64_t base = (uint64_t)(index % HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKETS) << shift;
+    return base + ((uint64_t)1 << shift) - 1;
+}
+
+void histogramReset(frame_time_histogram_t* histogram)
+{
+    memset(histogram, 0, sizeof(*histogram));
+    histogram->min = UINT64_MAX;
+}
+
+void histogramAdd(frame_time_histogram_t* histogram, uint64_t ns)
+{
+    histogram->counts[bucketIndex(ns)]++;
+    histogram->count++;
+    histogram->total += ns;
+    if(ns < histogram->min) {
+        histogram->min = ns;
+    }
+    if(ns > histogram->max) {
+        histogram->max = ns;
+    }
+}
+
+void histogramMerge(frame_time_histogram_t* dst, const frame_time_histogram_t* src)
+{
+    for(int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        dst->counts[i] += src->counts[i];
+    }
+    dst->count += src->count;
+    dst->total += src->total;
+    if(src->min < dst->min) {
+        dst->min = src->min;
+    }
+    if(src->max > dst->max) {
+        dst->max = src->max;
+    }
+}
+
+uint64_t histogramPercentile(const frame_time_histogram_t* histogram, double p)
+{
+    if(histogram->count == 0) {
+        return 0;
+    }
+    // rank of the sample we are after, 1 based
+    uint64_t rank = (uint64_t)(p * histogram->count + 0.5);
+    if(rank < 1) {
+        rank = 1;
+    }
+    if(rank > histogram->count) {
+        rank = histogram->count;
+    }
+    uint64_t seen = 0;
+    for(int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->counts[i];
+        if(seen >= rank) {
+            uint64_t edge = bucketUpperEdge(i);
+            return edge < histogram->max ? edge : histogram->max;
+        }
+    }
+    return histogram->max;
+}
@@ -0,0 +1,426 @@
+/**
+    Installation.cpp
+
+    Description:
+    Inventory parsing and installation loading for the fleet runner, see Installation.h.
+    The layout and palette files are JSON, but only a handful of numeric fields are needed from them, so
+    they are read with a small scanner that collects every "key": number pair in file order instead of
+    pulling in a JSON library.
+ */
+
+#include "Installation.h"
+#include "Shape.h"
+#include "Prng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <set>
+#include <string>
+#include <utility>
+
+#define TRIANGLE_SIDE_LENGTH 150 // side length of an Aurora panel, puts adjacent centroids 86.6 apart
+#define SYNTHETIC_TRACE_FRAMES 1024
+#define SYNTHETIC_TRACE_BINS 32
+#define DEFAULT_PALETTE_COLOURS 7
+
+/** A panel of a simulated layout. Only the centroid and orientation are used by the effects. */
+class SimPanelShape : public Shape {
+public:
+    SimPanelShape(double x, double y, int panelOrientation) {
+        centroid = Point(x, y);
+        orientation = panelOrientation;
+        vertices = NULL;
+        nVertices = 0;
+        area = 0;
+        shapeType = SHAPE_TRIANGLE;
+    }
+
+    bool isPointInsideShape(Point p) {
+        // the inscribed circle is close enough for a simulation
+        return Point::distance(p, centroid) < TRIANGLE_SIDE_LENGTH / (2.0 * sqrt(3.0));
+    }
+
+    void updateShape(Point* newCentroid, int* newOrientation) {
+        if(newCentroid != NULL) {
+            centroid = *newCentroid;
+        }
+        if(newOrientation != NULL) {
+            orientation = *newOrientation;
+        }
+    }
+};
+
+typedef struct {
+    std::string key;
+    double value;
+} json_field_t;
+
+/** Read a whole file into a string, false if it could not be read */
+static bool readFile(const std::string& path, std::string* contents)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if(file == NULL) {
+        return false;
+    }
+    char buffer[4096];
+    size_t n;
+    contents->clear();
+    while((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        contents->append(buffer, n);
+    }
+    fclose(file);
+    return true;
+}
+
+/** Collect every "key": number pair of a JSON document in the order they appear */
+static void scanJsonFields(const std::string& text, std::vector<json_field_t>* fields)
+{
+    size_t i = 0;
+    while(i < text.size()) {
+        if(text[i] != '"') {
+            i++;
+            continue;
+        }
+        size_t end = text.find('"', i + 1);
+        if(end == std::string::npos) {
+            return;
+        }
+        std::string key = text.substr(i + 1, end - i - 1);
+        i = end + 1;
+        while(i < text.size() && isspace((unsigned char)text[i])) {
+            i++;
+        }
+        if(i >= text.size() || text[i] != ':') {
+            continue;
+        }
+        i++;
+        const char* start = text.c_str() + i;
+        char* stop;
+        double value = strtod(start, &stop);
+        if(stop != start) {
+            json_field_t field;
+            field.key = key;
+            field.value = value;
+            fields->push_back(field);
+            i += stop - start;
+        }
+    }
+}
+
+static LayoutData* newLayout(int nPanels)
+{
+    LayoutData* layout = new LayoutData();
+    layout->nPanels = nPanels;
+    layout->panels = new Panel[nPanels];
+    return layout;
+}
+
+/** Load the positionData of an Aurora layout: a panelId followed by its x, y and o */
+static LayoutData* loadLayout(const std::string& path)
+{
+    std::string text;
+    if(!readFile(path, &text)) {
+        fprintf(stderr, "cannot read layout %s\n", path.c_str());
+        return NULL;
+    }
+    std::vector<json_field_t> fields;
+    scanJsonFields(text, &fields);
+
+    int nPanels = 0;
+    for(size_t i = 0; i < fields.size(); i++) {
+        if(fields[i].key == "panelId") {
+            nPanels++;
+        }
+    }
+    if(nPanels == 0) {
+        fprintf(stderr, "layout %s has no panels\n", path.c_str());
+        return NULL;
+    }
+
+    LayoutData* layout = newLayout(nPanels);
+    int panel = -1;
+    double x = 0;
+    double y = 0;
+    int orientation = 0;
+    for(size_t i = 0; i <= fields.size(); i++) {
+        if(i == fields.size() || fields[i].key == "panelId") {
+            if(panel >= 0) {
+                layout->panels[panel].shape = new SimPanelShape(x, y, orientation);
+            }
+            if(i == fields.size()) {
+                break;
+            }
+            panel++;
+            layout->panels[panel].panelId = (int)fields[i].value;
+            x = 0;
+            y = 0;
+            orientation = 0;
+        } else if(fields[i].key == "x") {
+            x = fields[i].value;
+        } else if(fields[i].key == "y") {
+            y = fields[i].value;
+        } else if(fields[i].key == "o") {
+            orientation = (int)fields[i].value;
+        }
+    }
+    return layout;
+}
+
+/**
+  * Grow a connected layout of nPanels triangles from a single panel, adding a random free neighbour
+  * of the layout at every step, the way people tend to extend their installations.
+  */
+static LayoutData* randomLayout(int nPanels, prng_t* random)
+{
+    const double height = TRIANGLE_SIDE_LENGTH * sqrt(3.0) / 2;
+    std::set<std::pair<int, int> > occupied;
+    std::vector<std::pair<int, int> > frontier;
+    frontier.push_back(std::make_pair(0, 0));
+
+    LayoutData* layout = newLayout(nPanels);
+    int n = 0;
+    while(n < nPanels) {
+        // pick a random candidate, swap-remove it from the frontier
+        int pick = prngBounded(random, frontier.size());
+        std::pair<int, int> cell = frontier[pick];
+        frontier[pick] = frontier.back();
+        frontier.pop_back();
+        if(!occupied.insert(cell).second) {
+            continue;
+        }
+
+        // triangle (i, j) of the lattice points up when i + j is even and shares its base with (i, j - 1),
+        // a triangle pointing down shares its top edge with (i, j + 1)
+        int i = cell.first;
+        int j = cell.second;
+        bool up = ((i + j) & 1) == 0;
+        double x = i * TRIANGLE_SIDE_LENGTH / 2.0;
+        double y = j * height + (up ? height / 3 : 2 * height / 3);
+        layout->panels[n].panelId = n + 1;
+        layout->panels[n].shape = new SimPanelShape(x, y, up ? 0 : 60);
+        n++;
+
+        frontier.push_back(std::make_pair(i - 1, j));
+        frontier.push_back(std::make_pair(i + 1, j));
+        frontier.push_back(std::make_pair(i, up ? j - 1 : j + 1));
+    }
+    return layout;
+}
+
+/** Load the hue/saturation/brightness entries of a palette file */
+static bool loadPalette(const std::string& path, installation_t* installation)
+{
+    std::string text;
+    if(!readFile(path, &text)) {
+        fprintf(stderr, "cannot read palette %s\n", path.c_str());
+        return false;
+    }
+    std::vector<json_field_t> fields;
+    scanJsonFields(text, &fields);
+
+    std::vector<HSV_t> colours;
+    for(size_t i = 0; i < fields.size(); i++) {
+        if(fields[i].key == "hue") {
+            HSV_t hsv;
+            hsv.H = (int)fields[i].value;
+            hsv.S = 100;
+            hsv.V = 100;
+            colours.push_back(hsv);
+        } else if(fields[i].key == "saturation" && !colours.empty()) {
+            colours.back().S = (int)fields[i].value;
+        } else if(fields[i].key == "brightness" && !colours.empty()) {
+            colours.back().V = (int)fields[i].value;
+        }
+    }
+    if(colours.empty()) {
+        fprintf(stderr, "palette %s has no colours\n", path.c_str());
+        return false;
+    }
+
+    installation->nColors = colours.size();
+    installation->palette = new RGB_t[colours.size()];
+    for(size_t i = 0; i < colours.size(); i++) {
+        HSVtoRGB(colours[i], &installation->palette[i]);
+    }
+    return true;
+}
+
+static void defaultPalette(installation_t* installation)
+{
+    installation->nColors = DEFAULT_PALETTE_COLOURS;
+    installation->palette = new RGB_t[DEFAULT_PALETTE_COLOURS];
+    for(int i = 0; i < DEFAULT_PALETTE_COLOURS; i++) {
+        HSV_t hsv;
+        hsv.H = i * 360 / DEFAULT_PALETTE_COLOURS;
+        hsv.S = 100;
+        hsv.V = 100;
+        HSVtoRGB(hsv, &installation->palette[i]);
+    }
+}
+
+/** Load an audio trace, one line of fft bins per frame. Lines shorter than the first one are padded with 0. */
+static bool loadTrace(const std::string& path, installation_t* installation)
+{
+    std::string text;
+    if(!readFile(path, &text)) {
+        fprintf(stderr, "cannot read audio trace %s\n", path.c_str());
+        return false;
+    }
+    std::vector<std::vector<int> > rows;
+    size_t start = 0;
+    while(start < text.size()) {
+        size_t end = text.find('\n', start);
+        if(end == std::string::npos) {
+            end = text.size();
+        }
+        std::string line = text.substr(start, end - start);
+        start = end + 1;
+        std::vector<int> row;
+        const char* p = line.c_str();
+        char* stop;
+        while(true) {
+            long value = strtol(p, &stop, 10);
+            if(stop == p) {
+                break;
+            }
+            row.push_back(value < 0 ? 0 : value > 255 ? 255 : (int)value);
+            p = stop;
+        }
+        if(!row.empty()) {
+            rows.push_back(row);
+        }
+    }
+    if(rows.empty()) {
+        fprintf(stderr, "audio trace %s has no frames\n", path.c_str());
+        return false;
+    }
+
+    installation->traceFrames = rows.size();
+    installation->traceBins = rows[0].size();
+    installation->trace = new uint8_t[installation->traceFrames * installation->traceBins]();
+    for(int f = 0; f < installation->traceFrames; f++) {
+        for(int b = 0; b < installation->traceBins && b < (int)rows[f].size(); b++) {
+            installation->trace[f * installation->traceBins + b] = rows[f][b];
+        }
+    }
+    return true;
+}
+
+/** A trace with low noise in every bin and a peak every few frames, each bin with its own period */
+static void randomTrace(installation_t* installation, prng_t* random)
+{
+    installation->traceFrames = SYNTHETIC_TRACE_FRAMES;
+    installation->traceBins = SYNTHETIC_TRACE_BINS;
+    installation->trace = new uint8_t[SYNTHETIC_TRACE_FRAMES * SYNTHETIC_TRACE_BINS];
+    for(int b = 0; b < SYNTHETIC_TRACE_BINS; b++) {
+        int binPeriod = 3 + prngBounded(random, 15);
+        for(int f = 0; f < SYNTHETIC_TRACE_FRAMES; f++) {
+            installation->trace[f * SYNTHETIC_TRACE_BINS + b] = (f % binPeriod == 0) ? 200 : prngBounded(random, 31);
+        }
+    }
+}
+
+/** Resolve a path from the inventory against the directory the inventory lives in */
+static std::string inventoryPath(const std::string& inventory, const std::string& path)
+{
+    if(path.empty() || path[0] == '/') {
+        return path;
+    }
+    size_t slash = inventory.rfind('/');
+    if(slash == std::string::npos) {
+        return path;
+    }
+    return inventory.substr(0, slash + 1) + path;
+}
+
+bool loadInventory(const char* path, std::vector<installation_t*>* installations)
+{
+    std::string text;
+    if(!readFile(path, &text)) {
+        fprintf(stderr, "cannot read inventory %s\n", path);
+        return false;
+    }
+
+    int lineNumber = 0;
+    size_t start = 0;
+    while(start < text.size()) {
+        size_t end = text.find('\n', start);
+        if(end == std::string::npos) {
+            end = text.size();
+        }
+        std::string line = text.substr(start, end - start);
+        start = end + 1;
+        lineNumber++;
+        size_t hash = line.find('#');
+        if(hash != std::string::npos) {
+            line.erase(hash);
+        }
+
+        char name[INSTALLATION_NAME_LENGTH];
+        char effect[INSTALLATION_NAME_LENGTH];
+        char layout[1024];
+        char palette[1024];
+        char audio[1024];
+        unsigned int seed;
+        int frames;
+        int n = sscanf(line.c_str(), "%63s %63s %1023s %1023s %1023s %u %d", name, effect, layout, palette, audio, &seed, &frames);
+        if(n <= 0) {
+            continue; // blank or comment
+        }
+        if(n != 7 || frames < 1) {
+            fprintf(stderr, "%s:%d: expected name effect layout palette audio seed frames\n", path, lineNumber);
+            return false;
+        }
+
+        installation_t* installation = new installation_t();
+        strcpy(installation->name, name);
+        strcpy(installation->effect, effect);
+        installation->seed = seed;
+        installation->frames = frames;
+        prng_t random;
+        prngSeed(&random, seed);
+
+        bool loaded = true;
+        int nRandomPanels;
+        if(sscanf(layout, "random:%d", &nRandomPanels) == 1 && nRandomPanels > 0) {
+            installation->layout = randomLayout(nRandomPanels, &random);
+        } else {
+            installation->layout = loadLayout(inventoryPath(path, layout));
+            loaded = installation->layout != NULL;
+        }
+        if(loaded) {
+            if(strcmp(palette, "default") == 0) {
+                defaultPalette(installation);
+            } else {
+                loaded = loadPalette(inventoryPath(path, palette), installation);
+            }
+        }
+        if(loaded) {
+            if(strcmp(audio, "random") == 0) {
+                randomTrace(installation, &random);
+            } else {
+                loaded = loadTrace(inventoryPath(path, audio), installation);
+            }
+        }
+        if(!loaded) {
+            fprintf(stderr, "%s:%d: installation %s not loaded\n", path, lineNumber, name);
+            installationFree(installation);
+            return false;
+        }
+        installations->push_back(installation);
+    }
+    return true;
+}
+
+void installationFree(installation_t* installation)
+{
+    if(installation == NULL) {
+        return;
+    }
+    delete installation->layout;
+    delete [] installation->palette;
+    delete [] installation->trace;
+    delete installation;
+}
@@ -0,0 +1,108 @@
+/**
+    WorkStealingPool.cpp
+
+    Description:
+    Work stealing task runner, see WorkStealingPool.h.
+    The tasks are coarse (a whole simulated installation each), so a mutex per deque costs nothing
+    measurable next to them. No task creates new tasks, so a worker that finds every deque empty can stop.
+ */
+
+#include "WorkStealingPool.h"
+#include <thread>
+#include <mutex>
+#include <deque>
+
+struct task_queue_t {
+    std::mutex lock;
+    std::deque<int> tasks;
+};
+
+typedef struct {
+    task_queue_t* queues;
+    int nWorkers;
+    task_fn fn;
+    void* arg;
+    worker_stats_t* stats;
+} steal_run_t;
+
+/** Take the next task from the worker's own deque, -1 if it is empty */
+static int popOwn(task_queue_t* queue)
+{
+    std::lock_guard<std::mutex> guard(queue->lock);
+    if(queue->tasks.empty()) {
+        return -1;
+    }
+    int task = queue->tasks.front();
+    queue->tasks.pop_front();
+    return task;
+}
+
+/** Take the task from the far end of another worker's deque, -1 if it is empty */
+static int steal(task_queue_t* queue)
+{
+    std::lock_guard<std::mutex> guard(queue->lock);
+    if(queue->tasks.empty()) {
+        return -1;
+    }
+    int task = queue->tasks.back();
+    queue->tasks.pop_back();
+    return task;
+}
+
+static void workerLoop(steal_run_t* run, int worker)
+{
+    worker_stats_t* stats = &run->stats[worker];
+    while(true) {
+        int task = popOwn(&run->queues[worker]);
+        if(task < 0) {
+            // look for work at the other workers, starting with the next one so thieves spread out
+            for(int i = 1; i < run->nWorkers && task < 0; i++) {
+                task = steal(&run->queues[(worker + i) % run->nWorkers]);
+            }
+            if(task < 0) {
+                return;
+            }
+            stats->stolen++;
+        }
+        run->fn(task, worker, run->arg);
+        stats->executed++;
+    }
+}
+
+void workStealingRun(int nWorkers, int nTasks, const int* order, task_fn fn, void* arg, worker_stats_t* stats)
+{
+    if(nWorkers < 1) {
+        nWorkers = 1;
+    }
+    steal_run_t run;
+    run.queues = new task_queue_t[nWorkers];
+    run.nWorkers = nWorkers;
+    run.fn = fn;
+    run.arg = arg;
+    run.stats = new worker_stats_t[nWorkers];
+    for(int i = 0; i < nWorkers; i++) {
+        run.stats[i].executed = 0;
+        run.stats[i].stolen = 0;
+    }
+    for(int i = 0; i < nTasks; i++) {
+        run.queues[i % nWorkers].tasks.push_back(order != NULL ? order[i] : i);
+    }
+
+    std::thread* threads = new std::thread[nWorkers - 1];
+    for(int i = 1; i < nWorkers; i++) {
+        threads[i - 1] = std::thread(workerLoop, &run, i);
+    }
+    workerLoop(&run, 0);
+    for(int i = 1; i < nWorkers; i++) {
+        threads[i - 1].join();
+    }
+
+    if(stats != NULL) {
+        for(int i = 0; i < nWorkers; i++) {
+            stats[i] = run.stats[i];
+        }
+    }
+    delete [] threads;
+    delete [] run.stats;
+    delete [] run.queues;
+}
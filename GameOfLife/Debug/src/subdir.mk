@@ -4,20 +4,53 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 CPP_SRCS += \
-../src/AuroraPlugin.cpp 
+../src/AuroraPlugin.cpp \
+../src/GameOfLife.cpp \
+../src/BeatCalibration.cpp \
+../src/DetectorState.cpp \
+../src/BandMapper.cpp \
+../src/PanelOccupancy.cpp \
+../src/Prng.cpp \
+../src/LifeGrid.cpp \
+../src/LifeHistory.cpp \
+../src/LifeHashlife.cpp \
+../src/LayoutCache.cpp \
+../src/PanelAutomaton.cpp 
 
 OBJS += \
-./src/AuroraPlugin.o 
+./src/AuroraPlugin.o \
+./src/GameOfLife.o \
+./src/BeatCalibration.o \
+./src/DetectorState.o \
+./src/BandMapper.o \
+./src/PanelOccupancy.o \
+./src/Prng.o \
+./src/LifeGrid.o \
+./src/LifeHistory.o \
+./src/LifeHashlife.o \
+./src/LayoutCache.o \
+./src/PanelAutomaton.o 
 
 CPP_DEPS += \
-./src/AuroraPlugin.d 
+./src/AuroraPlugin.d \
+./src/GameOfLife.d \
+./src/BeatCalibration.d \
+./src/DetectorState.d \
+./src/BandMapper.d \
+./src/PanelOccupancy.d \
+./src/Prng.d \
+./src/LifeGrid.d \
+./src/LifeHistory.d \
+./src/LifeHashlife.d \
+./src/LayoutCache.d \
+./src/PanelAutomaton.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
 src/%.o: ../src/%.cpp
 	@echo 'Building file: $<'
 	@echo 'Invoking: Cross G++ Compiler'
-	g++ -I../inc -O0 -g3 -Wall -c -fmessage-length=0 -std=c++11 -fPIC -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	g++ -I../inc -O0 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -fPIC -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
 	@echo 'Finished building: $<'
 	@echo ' '
 
@@ -0,0 +1,65 @@
+/**
+    GameOfLife.h
+
+    Description:
+    The GameOfLife effect as a self contained instance. The cell grid, the frequency bin history and the beat
+    detector calibration hang off a game_of_life_t instead of file statics, and the instance never calls into the host:
+    the fft bins of a frame are handed in by the caller. AuroraPlugin.cpp keeps one instance behind the
+    initPlugin/getPluginFrame/pluginCleanup ABI, the simulator and benchmarks can create as many as they like.
+ */
+
+#ifndef INC_GAMEOFLIFE_H_
+#define INC_GAMEOFLIFE_H_
+
+#include <stdint.h>
+#include "AuroraPlugin.h"
+#include "ColorUtils.h"
+#include "LayoutProcessingUtils.h"
+
+struct game_of_life_t;
+
+/**
+ * @description: create an instance for a layout and palette. Both have to outlive the instance.
+ * @param randomSeed: seeds the instance's random numbers, the same seed replays the same run
+ */
+game_of_life_t* gameOfLifeCreate(LayoutData* layoutData, RGB_t* palette, int nColours, uint64_t randomSeed);
+
+/**
+ * @description: number of fft bins gameOfLifeFrame() reads
+ */
+int gameOfLifeFftBins(const game_of_life_t* instance);
+
+/**
+ * @description: advance the instance by one generation and render every panel
+ * @param fftBins: gameOfLifeFftBins() bins sampled from the host for this frame
+ * @param frames: buffer with room for one frame per panel
+ * @param nFrames: filled with the number of frames written
+ */
+void gameOfLifeFrame(game_of_life_t* instance, const uint8_t* fftBins, Frame_t* frames, int* nFrames);
+
+/**
+ * @description: run a multi state automaton on the panels and their neighbours instead of Life on the hidden
+ * grid, see PanelAutomaton.h for the rules that can be given. NULL goes back to the grid.
+ * @return: false if the rule could not be read, the effect is then left as it was
+ */
+bool gameOfLifeSetPanelRule(game_of_life_t* instance, const char* rule);
+
+/**
+ * @description: seed the beat detector from a state saved by gameOfLifeSaveDetector(), skipping the
+ * calibration. Call it right after gameOfLifeCreate(). A NULL path is ignored.
+ * @return: true if the state was recent enough and saved for the same number of fft bins
+ */
+bool gameOfLifeRestoreDetector(game_of_life_t* instance, const char* path);
+
+/**
+ * @description: save what the beat detector has learnt so the next instance can start from it. Nothing is
+ * written before the detector has been calibrated or when path is NULL.
+ */
+void gameOfLifeSaveDetector(const game_of_life_t* instance, const char* path);
+
+/**
+ * @description: free the instance. NULL is ignored.
+ */
+void gameOfLifeDestroy(game_of_life_t* instance);
+
+#endif /* INC_GAMEOFLIFE_H_ */
@@ -0,0 +1,97 @@
+/**
+    LifeGrid.h
+
+    Description:
+    The square grid the Game of Life runs on, laid over the panel layout and never shown directly: the panels
+    show the live cells around their centroids. Each row of the grid is a run of 64 bit words with one bit per
+    cell, so a generation is computed 64 cells at a time with bitwise adders counting the neighbours. Every
+    cell also has a colour, set when it is spawned or born (the average of the three parents) and kept while
+    it lives. Cells that move off the edge of the grid die.
+
+    The grid also keeps a Zobrist hash of its live cells: the XOR of a fixed random key per live cell. It is
+    updated only for the cells that change, so two generations with the same cells have the same hash and
+    comparing hashes finds a repeated generation without comparing grids (see LifeHistory.h).
+ */
+
+#ifndef INC_LIFEGRID_H_
+#define INC_LIFEGRID_H_
+
+#include <stdint.h>
+#include "LayoutProcessingUtils.h"
+
+typedef struct {
+    uint8_t R;
+    uint8_t G;
+    uint8_t B;
+} cell_colour_t;
+
+typedef struct {
+    int width;                  // cells per row
+    int height;                 // rows
+    int wordsPerRow;
+    float originX;              // world position of the corner of cell (0, 0)
+    float originY;
+    float cellSize;             // width of a cell in layout units
+    uint64_t* cells;            // bit x % 64 of word y * wordsPerRow + x / 64 is set while cell (x, y) is alive
+    uint64_t* next;             // the next generation is built here and then swapped with cells
+    cell_colour_t* colours;     // colour of cell (x, y) at y * width + x, only meaningful while it is alive
+    uint64_t hash;              // Zobrist hash of the live cells
+} life_grid_t;
+
+/**
+ * @description: make a grid of empty cells covering the panel centroids of a layout
+ * @param cellSize: width of a cell in layout units
+ * @param margin: cells of extra room around the outermost centroids
+ */
+void lifeGridInit(life_grid_t* grid, LayoutData* layoutData, float cellSize, int margin);
+
+/**
+ * @description: free the grid
+ */
+void lifeGridFree(life_grid_t* grid);
+
+/**
+ * @description: the cell containing a point
+ * @return: false if the point is outside the grid
+ */
+bool lifeGridCellAt(const life_grid_t* grid, float x, float y, int* cellX, int* cellY);
+
+/**
+ * @description: the Zobrist key of cell y * width + x, derived from the index rather than kept in a table
+ */
+static inline uint64_t lifeGridKey(int cell)
+{
+    uint64_t z = (uint64_t)(cell + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline bool lifeGridAlive(const life_grid_t* grid, int x, int y)
+{
+    return (grid->cells[y * grid->wordsPerRow + (x >> 6)] >> (x & 63)) & 1;
+}
+
+/**
+ * @description: OR a 5x5 pattern mask (see LifePatterns.h) into the grid with its corner at (left, top)
+ * and give the cells it sets a colour. The parts of the pattern outside the grid are dropped.
+ */
+void lifeGridStamp(life_grid_t* grid, int left, int top, uint32_t mask, cell_colour_t colour);
+
+/**
+ * @description: advance the grid by one generation of Conway's rules, B3/S23
+ */
+void lifeGridStep(life_grid_t* grid);
+
+/**
+ * @description: make the generation written into grid->next the current one, for generations computed
+ * elsewhere (see LifeHashlife.h). A cell born in between takes the colour of the nearest cell that was alive.
+ */
+void lifeGridAdopt(life_grid_t* grid);
+
+/**
+ * @description: the number of live cells
+ */
+int lifeGridPopulation(const life_grid_t* grid);
+
+#endif /* INC_LIFEGRID_H_ */
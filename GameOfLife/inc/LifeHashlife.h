@@ -0,0 +1,70 @@
+/**
+    LifeHashlife.h
+
+    Description:
+    Hashlife for the Life grid (see LifeGrid.h): the grid is turned into a quadtree whose nodes are shared
+    (the same 2^n x 2^n block of cells is one node wherever it appears) and each node remembers what its centre
+    looks like 2^k generations later. A pattern that repeats in space or time is then only ever computed once,
+    so the grid can jump many generations ahead for little more than the cost of building the tree. The tree
+    stops at blocks of 8x8 cells held in one 64 bit word, and the 16x16 blocks above them are stepped a whole
+    row of cells at a time like the grid itself.
+    The nodes live in a fixed size cache. Before a jump that finds more than half of it in use, the nodes that
+    have gone unused the longest are dropped until at most a quarter is left; if a jump fills it anyway the jump
+    is retried on an empty cache.
+
+    During a jump the cells live on an unbounded plane, so cells that wander off the grid can still come back
+    and act on it before they are dropped at the end of the jump.
+ */
+
+#ifndef INC_LIFEHASHLIFE_H_
+#define INC_LIFEHASHLIFE_H_
+
+#include <stdint.h>
+#include "LifeGrid.h"
+
+#define LIFE_HASHLIFE_LEAF_LEVEL 3  // the smallest nodes are 2^this cells across
+#define LIFE_HASHLIFE_MAX_LEVEL 30  // largest quadtree node is 2^this cells across
+
+typedef struct {
+    int32_t child[4];           // the north west, north east, south west and south east quarters, -1 in a leaf
+    uint64_t bits;              // the cells of a leaf, bit r * 8 + c for row r and column c
+    int32_t result;             // the centre 2^resultLog2 generations later, -1 if not known
+    int32_t next;               // next node in the same hash bucket, or in the free list
+    uint32_t lastUsed;          // clock of the last jump that used this node
+    uint64_t population;        // live cells
+    int8_t level;               // the node is 2^level cells across, -1 while it is not in use
+    int8_t resultLog2;
+} life_hash_node_t;
+
+typedef struct {
+    int capacity;               // nodes in the cache
+    life_hash_node_t* nodes;
+    int32_t* buckets;           // first node of each hash bucket, -1 if empty
+    uint32_t bucketMask;
+    int32_t freeList;           // first unused node, -1 if the cache is full
+    int nFree;
+    int32_t empty[LIFE_HASHLIFE_MAX_LEVEL + 1]; // the empty node of every level, always kept
+    uint8_t* marks;             // scratch space to find the nodes to keep
+    uint32_t clock;             // counts the jumps
+    bool full;                  // the cache ran out during the current jump
+} life_hashlife_t;
+
+/**
+ * @description: make an empty node cache
+ * @param capacity: number of nodes the cache holds
+ */
+void hashlifeInit(life_hashlife_t* hashlife, int capacity);
+
+/**
+ * @description: move the grid 2^log2Generations generations ahead. Cells born on the way take the colour of
+ * the nearest cell that was alive before.
+ * @return: false if the grid is too large for the cache, the grid is left as it was
+ */
+bool hashlifeAdvance(life_hashlife_t* hashlife, life_grid_t* grid, int log2Generations);
+
+/**
+ * @description: free the cache
+ */
+void hashlifeFree(life_hashlife_t* hashlife);
+
+#endif /* INC_LIFEHASHLIFE_H_ */
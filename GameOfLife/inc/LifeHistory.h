@@ -0,0 +1,35 @@
+/**
+    LifeHistory.h
+
+    Description:
+    Remembers the grid hashes (see LifeGrid.h) of the last few generations in a ring, so a grid that has
+    settled into a still life or a short oscillator is noticed as soon as it repeats: a generation whose hash
+    matches the one p generations back has started a cycle of period p. The ring has a fixed length, so
+    checking a generation costs the same however large the grid is.
+ */
+
+#ifndef INC_LIFEHISTORY_H_
+#define INC_LIFEHISTORY_H_
+
+#include <stdint.h>
+
+#define LIFE_HISTORY_LENGTH 16  // longest cycle period that is detected
+
+typedef struct {
+    uint64_t hashes[LIFE_HISTORY_LENGTH];
+    int next;                   // slot the next hash goes into
+    int count;                  // hashes remembered so far, at most LIFE_HISTORY_LENGTH
+} life_history_t;
+
+/**
+ * @description: forget every generation
+ */
+void lifeHistoryReset(life_history_t* history);
+
+/**
+ * @description: remember the hash of a new generation and check it against the ones before it
+ * @return: the shortest period p for which the generation p back had the same hash, 0 if there is none
+ */
+int lifeHistoryPush(life_history_t* history, uint64_t hash);
+
+#endif /* INC_LIFEHISTORY_H_ */
@@ -0,0 +1,71 @@
+/**
+    LifePatterns.h
+
+    Description:
+    The Game of Life patterns the plugin spawns, built at compile time. Every pattern is drawn in a 5x5 box
+    stored as a 25 bit mask, bit r * 5 + c for row r and column c. The table holds each pattern in all eight
+    orientations the square grid supports (four rotations, each of them also mirrored), so spawning a pattern
+    in any orientation is a table lookup followed by ORing five rows of bits into the grid.
+ */
+
+#ifndef INC_LIFEPATTERNS_H_
+#define INC_LIFEPATTERNS_H_
+
+#include <stdint.h>
+
+#define LIFE_PATTERN_SIZE 5 // patterns are drawn in a LIFE_PATTERN_SIZE x LIFE_PATTERN_SIZE box
+#define LIFE_ORIENTATIONS 8 // rotations and mirror images of a square pattern
+
+// Row r of a pattern as a string of five 0/1 columns, e.g. LIFE_ROW(0, 1, 1, 0, 0)
+#define LIFE_ROW(r, a, b, c, d, e) (((uint32_t)(a) | (b) << 1 | (c) << 2 | (d) << 3 | (e) << 4) << (5 * (r)))
+
+// Spaceships
+#define LIFE_GLIDER (LIFE_ROW(0, 1, 0, 0, 0, 0) | LIFE_ROW(1, 0, 0, 1, 0, 0) | LIFE_ROW(2, 1, 1, 1, 0, 0))
+#define LIFE_LWSS (LIFE_ROW(0, 1, 0, 0, 1, 0) | LIFE_ROW(1, 0, 0, 0, 0, 1) | LIFE_ROW(2, 1, 0, 0, 0, 1) | \
+                   LIFE_ROW(3, 0, 1, 1, 1, 1)) // lightweight spaceship
+// Oscillators
+#define LIFE_BLINKER (LIFE_ROW(0, 0, 1, 0, 0, 0) | LIFE_ROW(1, 0, 1, 0, 0, 0) | LIFE_ROW(2, 0, 1, 0, 0, 0))
+#define LIFE_TOAD (LIFE_ROW(0, 0, 1, 1, 1, 0) | LIFE_ROW(1, 1, 1, 1, 0, 0))
+// Still lifes
+#define LIFE_BLOCK (LIFE_ROW(0, 1, 1, 0, 0, 0) | LIFE_ROW(1, 1, 1, 0, 0, 0))
+#define LIFE_BEEHIVE (LIFE_ROW(0, 0, 1, 1, 0, 0) | LIFE_ROW(1, 1, 0, 0, 1, 0) | LIFE_ROW(2, 0, 1, 1, 0, 0))
+
+/**
+ * @description: the source cell of cell (r, c) of orientation o. Bit 0 of o mirrors the columns, bit 1 the
+ * rows and bit 2 swaps rows and columns; together they give the eight symmetries of the square.
+ */
+constexpr int lifeSourceBit(int orientation, int r, int c)
+{
+    return (orientation & 4)
+        ? ((orientation & 1) ? 4 - c : c) * 5 + ((orientation & 2) ? 4 - r : r)
+        : ((orientation & 2) ? 4 - r : r) * 5 + ((orientation & 1) ? 4 - c : c);
+}
+
+/**
+ * @description: a pattern mask in orientation o, built one bit at a time from bit onwards
+ */
+constexpr uint32_t lifeOrient(uint32_t mask, int orientation, int bit = 0)
+{
+    return bit == LIFE_PATTERN_SIZE * LIFE_PATTERN_SIZE ? 0 :
+        (((mask >> lifeSourceBit(orientation, bit / 5, bit % 5)) & 1) << bit) | lifeOrient(mask, orientation, bit + 1);
+}
+
+#define LIFE_ORIENTED(mask) { lifeOrient(mask, 0), lifeOrient(mask, 1), lifeOrient(mask, 2), lifeOrient(mask, 3), \
+                              lifeOrient(mask, 4), lifeOrient(mask, 5), lifeOrient(mask, 6), lifeOrient(mask, 7) }
+
+#define LIFE_PATTERNS 6
+
+// Every pattern in every orientation, indexed [pattern][orientation]
+static constexpr uint32_t lifePatterns[LIFE_PATTERNS][LIFE_ORIENTATIONS] = {
+    LIFE_ORIENTED(LIFE_GLIDER),
+    LIFE_ORIENTED(LIFE_LWSS),
+    LIFE_ORIENTED(LIFE_BLINKER),
+    LIFE_ORIENTED(LIFE_TOAD),
+    LIFE_ORIENTED(LIFE_BLOCK),
+    LIFE_ORIENTED(LIFE_BEEHIVE),
+};
+
+static_assert(lifeOrient(LIFE_GLIDER, 0) == LIFE_GLIDER, "orientation 0 is the pattern as drawn");
+static_assert(lifeOrient(LIFE_BLINKER, 4) == (LIFE_ROW(1, 1, 1, 1, 0, 0)), "a transposed vertical blinker is horizontal");
+
+#endif /* INC_LIFEPATTERNS_H_ */
@@ -0,0 +1,101 @@
+/**
+    PanelAutomaton.h
+
+    Description:
+    Cellular automata with any number of states (up to 16) run directly on the panels, with the panels that
+    share an edge as neighbours. The rule is compiled into a transition table when the automaton is made: a
+    panel's next state is table[state * stride + index], where the index is the number of neighbours in each
+    counted state written as a number in base (most neighbours + 1). Every rule then steps with the same loop
+    of table lookups, without any code that depends on the rule. The states are packed 2 or 4 bits per panel.
+
+    The rules come in two families, both written as text (see automatonParseRule()):
+    - Generations rules such as Brian's Brain: a dead panel is born and a live one survives depending on its
+      number of live neighbours, a live panel that does not survive goes through the remaining states as it
+      dies and can not be born again until it is dead.
+    - Wireworld: every panel starts as a conductor, an electron head turns into a tail and then into a
+      conductor again, and a conductor next to one or two heads becomes a head.
+ */
+
+#ifndef INC_PANELAUTOMATON_H_
+#define INC_PANELAUTOMATON_H_
+
+#include <stdint.h>
+
+#define AUTOMATON_MAX_STATES 16
+#define AUTOMATON_MAX_COUNTED 2     // states whose neighbours are counted separately
+#define AUTOMATON_LIVE_STATE 1      // alive in a Generations rule and an electron head in Wireworld
+
+typedef enum {
+    AUTOMATON_GENERATIONS,
+    AUTOMATON_WIREWORLD,
+} automaton_family_t;
+
+typedef struct {
+    automaton_family_t family;
+    int nStates;
+    uint32_t birth;             // Generations: bit n is set if a dead panel with n live neighbours is born
+    uint32_t survive;           // Generations: bit n is set if a live panel with n live neighbours survives
+    int restState;              // the state every panel starts in
+    int nCounted;
+    int counted[AUTOMATON_MAX_COUNTED]; // the states whose neighbours are counted
+    float level[AUTOMATON_MAX_STATES];  // how brightly a panel shows each state, 0 to 1
+} automaton_rule_t;
+
+typedef struct {
+    int nPanels;
+    int bitsPerState;           // 2 or 4
+    uint64_t* states;           // state of panel p in bits (p * bitsPerState) % 64 of word p * bitsPerState / 64
+    uint64_t* previous;         // the states of the generation before
+    const int* adjacencyStart;  // the neighbours of panel p are adjacency[adjacencyStart[p]] up to adjacency[adjacencyStart[p + 1]]
+    const int* adjacency;
+    int stride;                 // table entries per state
+    uint16_t weight[AUTOMATON_MAX_STATES]; // what a neighbour in each state adds to the table index
+    uint8_t* table;
+} panel_automaton_t;
+
+/**
+ * @description: read a rule: "Wireworld", "BriansBrain", "StarWars", "Life" or a Generations rule written as
+ * B<birth counts>/S<survival counts>/C<states>, e.g. "B2/S/C3" for Brian's Brain. /C<states> can be left out
+ * for the two state rules.
+ * @return: false if the text is not a rule
+ */
+bool automatonParseRule(const char* text, automaton_rule_t* rule);
+
+/**
+ * @description: make an automaton with every panel in the rule's rest state
+ * @param adjacencyStart, adjacency: the panel neighbours, they have to outlive the automaton
+ */
+void automatonInit(panel_automaton_t* automaton, const automaton_rule_t* rule, int nPanels, const int* adjacencyStart, const int* adjacency);
+
+static inline int automatonWordState(const uint64_t* words, int bitsPerState, int panel)
+{
+    int bit = panel * bitsPerState;
+    return (words[bit >> 6] >> (bit & 63)) & ((1 << bitsPerState) - 1);
+}
+
+static inline int automatonState(const panel_automaton_t* automaton, int panel)
+{
+    return automatonWordState(automaton->states, automaton->bitsPerState, panel);
+}
+
+static inline int automatonPreviousState(const panel_automaton_t* automaton, int panel)
+{
+    return automatonWordState(automaton->previous, automaton->bitsPerState, panel);
+}
+
+/**
+ * @description: put a panel in a state
+ */
+void automatonSetState(panel_automaton_t* automaton, int panel, int state);
+
+/**
+ * @description: advance every panel by one generation
+ */
+void automatonStep(panel_automaton_t* automaton);
+
+/**
+ * @description: free the states and the table
+ */
+void automatonFree(panel_automaton_t* automaton);
+
+#endif /* INC_PANELAUTOMATON_H_ */
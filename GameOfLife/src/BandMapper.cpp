@@ -0,0 +1,94 @@
+/**
+    BandMapper.cpp
+
+    Description:
+    Maps the fft onto log spaced bands, see BandMapper.h.
+    Band b covers the fft from (nFftBins + 1)^(b / nBands) - 1 to (nFftBins + 1)^((b + 1) / nBands) - 1 in units
+    of bins, so the bands start at the bottom of bin 0 and end at the top of the last bin. A bin is weighted by
+    how much of it lies inside the band.
+ */
+
+#include "BandMapper.h"
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+#define MIN_BIN_OVERLAP 1e-6 // overlaps smaller than this are rounding errors at the band edges
+
+void bandMapperInit(band_mapper_t* mapper, int nFftBins, int nBands)
+{
+    mapper->nFftBins = nFftBins;
+    mapper->nBands = nBands > 0 ? nBands : 0;
+    mapper->bandStart = new int[mapper->nBands + 1];
+
+    std::vector<uint16_t> bins;
+    std::vector<uint32_t> weights;
+    std::vector<double> overlaps;
+    double lower = 0;
+    for(int b = 0; b < mapper->nBands; b++) {
+        double upper = pow(nFftBins + 1.0, (double)(b + 1) / mapper->nBands) - 1.0;
+        if(b == mapper->nBands - 1) {
+            upper = nFftBins;
+        }
+        mapper->bandStart[b] = bins.size();
+
+        // the part of every bin inside [lower, upper)
+        overlaps.clear();
+        int first = std::max((int)floor(lower), 0);
+        for(int k = first; k < nFftBins && k < upper; k++) {
+            double overlap = std::min(upper, k + 1.0) - std::max(lower, (double)k);
+            if(overlap > MIN_BIN_OVERLAP) {
+                bins.push_back(k);
+                overlaps.push_back(overlap);
+            }
+        }
+
+        // weights in fixed point, the rounding left over goes to the heaviest bin so they add up exactly
+        double width = upper - lower;
+        uint32_t total = 0;
+        size_t heaviest = weights.size();
+        for(size_t i = 0; i < overlaps.size(); i++) {
+            uint32_t weight = (uint32_t)(overlaps[i] / width * BAND_WEIGHT_ONE + 0.5);
+            weights.push_back(weight);
+            total += weight;
+            if(weight > weights[heaviest] || i == 0) {
+                heaviest = weights.size() - 1;
+            }
+        }
+        if(!overlaps.empty()) {
+            weights[heaviest] += BAND_WEIGHT_ONE - total;
+        }
+        lower = upper;
+    }
+    mapper->bandStart[mapper->nBands] = bins.size();
+
+    mapper->bin = new uint16_t[bins.size() > 0 ? bins.size() : 1];
+    mapper->weight = new uint32_t[weights.size() > 0 ? weights.size() : 1];
+    std::copy(bins.begin(), bins.end(), mapper->bin);
+    std::copy(weights.begin(), weights.end(), mapper->weight);
+}
+
+void bandMapperApply(const band_mapper_t* mapper, const uint8_t* fftBins, uint8_t* bands)
+{
+    const int* bandStart = mapper->bandStart;
+    const uint16_t* bin = mapper->bin;
+    const uint32_t* weight = mapper->weight;
+    for(int b = 0; b < mapper->nBands; b++) {
+        uint32_t power = BAND_WEIGHT_ONE / 2; // round to nearest
+        for(int i = bandStart[b]; i < bandStart[b + 1]; i++) {
+            power += weight[i] * fftBins[bin[i]];
+        }
+        bands[b] = power / BAND_WEIGHT_ONE;
+    }
+}
+
+void bandMapperFree(band_mapper_t* mapper)
+{
+    delete [] mapper->bandStart;
+    delete [] mapper->bin;
+    delete [] mapper->weight;
+    mapper->bandStart = NULL;
+    mapper->bin = NULL;
+    mapper->weight = NULL;
+    mapper->nBands = 0;
+}
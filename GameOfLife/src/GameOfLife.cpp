@@ -0,0 +1,616 @@
+/**
+    GameOfLife.cpp
+
+    Description:
+    Beat Detection, FFT to light source color and Panel Color calculations based on FrequncyStars by Nathan Dyck.
+    The cells live on a hidden square grid laid over the panels (see LifeGrid.h) and follow Conway's Game of Life.
+    Whenever a beat is detected a pattern from LifePatterns.h is spawned at the center of a random panel: the
+    frequency band picks the pattern and the orientation is random. Each panel shows the live cells around its
+    centroid, and each loop calculates the next generation of the grid.
+    Once the grid repeats itself (see LifeHistory.h) the frames of one period are recorded and then replayed
+    without stepping or rendering the grid, until the next beat spawns a pattern. A grid that stays stuck in a
+    cycle for too long gets a random pattern spawned on it. A beat as loud as the loudest so far throws the grid
+    many generations ahead in one go (see LifeHashlife.h).
+    Instead of the grid, the panels themselves can run a multi state automaton such as Brian's Brain or
+    Wireworld (see PanelAutomaton.h and gameOfLifeSetPanelRule()). Beats then bring a free panel and its
+    neighbours to life, and a panel that comes to life takes the colour of the live neighbours that woke it.
+    All state lives in a game_of_life_t so any number of instances can run side by side, see GameOfLife.h.
+ */
+
+#include "GameOfLife.h"
+#include <stdlib.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "Logger.h"
+#include "BeatCalibration.h"
+#include "DetectorState.h"
+#include "BandMapper.h"
+#include "PanelOccupancy.h"
+#include "Prng.h"
+#include "LifeGrid.h"
+#include "LifePatterns.h"
+#include "LifeHistory.h"
+#include "LifeHashlife.h"
+#include "LayoutCache.h"
+#include "PanelAutomaton.h"
+#include <vector>
+#include <algorithm>
+
+#define MAX_PALETTE_COLOURS 7   // if more colours then this, we will use just the first this many
+#define BASE_COLOUR_R 0 // these three settings defined the background colour; set to black
+#define BASE_COLOUR_G 0
+#define BASE_COLOUR_B 0
+#define ADJACENT_PANEL_DISTANCE 86.599995   // hard coded distance between adjacent panels; this ideally should be autodetected
+#define TRANSITION_TIME 2  // the transition time to send to panels; set to 100ms currently
+#define LOG_LAYOUT false // print every palette colour and panel position on start-up
+#define MINIMUM_INTENSITY 0.2  // the minimum intensity of a source
+#define TRIGGER_THRESHOLD 0.7 // used to calculate whether to add a source
+#define LIFE_CELLS_PER_PANEL 4 // grid cells across the distance between two adjacent panels
+#define LIFE_GRID_MARGIN 8 // grid cells around the outermost panels, patterns leaving the grid die
+#define LIFE_RENDER_RADIUS 1.0 // a panel shows the cells up to this many panel distances from its centroid
+#define LIFE_FULL_WEIGHT 4.0 // a panel shows the full colour once the weights of its live cells add up to this
+#define LIFE_CORE_RADIUS 0.5 // a panel counts as taken while a cell this close to its centroid is alive
+#define LIFE_RESEED_GENERATIONS 300 // spawn a random pattern once live cells have repeated for this many generations; 0 never does
+#define LIFE_HASHLIFE_NODES 32768 // quadtree nodes kept for fast forwarding the grid; 0 turns fast forwarding off
+#define LIFE_FAST_FORWARD_LOG2 6 // a fast forward moves the grid 2^this many generations ahead
+#define LIFE_FAST_FORWARD_INTENSITY 1.0 // beats at least this intense fast forward the grid
+#define LIFE_FAST_FORWARD_INTERVAL 100 // frames between two fast forwards at the least
+
+// A grid cell a panel shows, with the weight its colour is mixed in with
+typedef struct {
+    int x;                      // the cell in the grid
+    int y;
+    float weight;
+    bool core;                  // close enough to the centroid to make the panel taken
+} footprint_t;
+
+/** Here we store the information accociated with each frequency bin. This
+ allows for tracking a degree of historical information.
+ */
+typedef struct {
+    uint32_t latest_minimum;
+    uint32_t soundPower;
+    int16_t colour;
+    uint32_t runningMax;
+    uint32_t runningMin;
+    uint32_t maximumTrigger;
+    uint32_t previousPower;
+    uint32_t secondPreviousPower;
+} freq_bin;
+
+struct game_of_life_t {
+    RGB_t* paletteColours;          // the colour palette, owned by the caller
+    int nColours;                   // the number of colours of the palette in use
+    LayoutData* layoutData;         // the panel layout, owned by the caller
+    life_grid_t grid;               // the cells
+    int* footprintStart;            // the cells panel p shows are footprint[footprintStart[p]] up to footprint[footprintStart[p + 1]]
+    footprint_t* footprint;
+    panel_occupancy_t occupancy;    // the panels with live cells at their centre, new patterns go to a free panel
+    prng_t prng;                    // this instance's random numbers
+    freq_bin freq_bins[MAX_PALETTE_COLOURS]; // this is our array for frequency bin historical information.
+    beat_calibration_t calibration; // levels of the first frames, the frequency bins are seeded from them
+    band_mapper_t bandMapper;       // maps the fft onto one band per palette colour
+    life_history_t history;         // hashes of the last generations, to notice the grid repeating
+    Frame_t* replayFrames;          // the frames of one cycle, LIFE_HISTORY_LENGTH rows of one frame per panel
+    int replayPeriod;               // period of the cycle the grid is in, 0 while it is not known to be in one
+    int replayRecorded;             // generations of the cycle recorded so far, it replays once all are
+    int replayPosition;             // the recorded generation to show next
+    int cycleGenerations;           // generations since the grid started repeating
+    life_hashlife_t hashlife;       // memoised generations for fast forwarding
+    int framesSinceFastForward;
+    bool panelMode;                 // the panels run panelRule instead of showing the grid
+    automaton_rule_t panelRule;
+    panel_automaton_t automaton;
+    layout_cache_t* layoutCache;    // the panel neighbours for the automaton, NULL until a rule is set
+    cell_colour_t* panelColours;    // the colour each panel shows the automaton's states in
+};
+
+/**
+  * @description: add a value to a running max.
+  * @param: runningMax is current runningMax, valueToAdd is added to runningMax, effectiveTrail
+  *         defines how many values are effectively tracked. Note this is an approximation.
+  * @return: int returned as new runningMax.
+  */
+static int addToRunningMax(int runningMax, int valueToAdd, int effectiveTrail) {
+    int trail = effectiveTrail;
+    if (valueToAdd > runningMax && effectiveTrail > 1) {
+        trail = trail / 2;
+    }
+    return runningMax - ((float)runningMax / effectiveTrail) + ((float)valueToAdd / trail);
+}
+
+/**
+  * @description: list the grid cells every panel shows and their weights. A cell at a distance of d panels is
+  * mixed in with 1 / (d^2 * 1.5 + 1), the falloff the light sources of the other plugins use.
+  */
+static void buildFootprints(game_of_life_t* instance)
+{
+    LayoutData* layoutData = instance->layoutData;
+    const life_grid_t* grid = &instance->grid;
+    int reach = (int)ceil(LIFE_RENDER_RADIUS * LIFE_CELLS_PER_PANEL);
+    std::vector<footprint_t> footprint;
+    instance->footprintStart = new int[layoutData->nPanels + 1];
+    for(int p = 0; p < layoutData->nPanels; p++) {
+        instance->footprintStart[p] = footprint.size();
+        const Point& centroid = layoutData->panels[p].shape->getCentroid();
+        int cx;
+        int cy;
+        if(!lifeGridCellAt(grid, centroid.x, centroid.y, &cx, &cy)) {
+            continue;
+        }
+        for(int y = std::max(cy - reach, 0); y <= std::min(cy + reach, grid->height - 1); y++) {
+            for(int x = std::max(cx - reach, 0); x <= std::min(cx + reach, grid->width - 1); x++) {
+                float dx = (grid->originX + (x + 0.5) * grid->cellSize - centroid.x) / ADJACENT_PANEL_DISTANCE;
+                float dy = (grid->originY + (y + 0.5) * grid->cellSize - centroid.y) / ADJACENT_PANEL_DISTANCE;
+                float d2 = dx * dx + dy * dy;
+                if(d2 > LIFE_RENDER_RADIUS * LIFE_RENDER_RADIUS) {
+                    continue;
+                }
+                footprint_t entry;
+                entry.x = x;
+                entry.y = y;
+                entry.weight = 1.0 / (d2 * 1.5 + 1.0);
+                entry.core = d2 <= LIFE_CORE_RADIUS * LIFE_CORE_RADIUS;
+                footprint.push_back(entry);
+            }
+        }
+    }
+    instance->footprintStart[layoutData->nPanels] = footprint.size();
+    instance->footprint = new footprint_t[footprint.size() > 0 ? footprint.size() : 1];
+    std::copy(footprint.begin(), footprint.end(), instance->footprint);
+}
+
+game_of_life_t* gameOfLifeCreate(LayoutData* layoutData, RGB_t* palette, int nColours, uint64_t randomSeed)
+{
+    game_of_life_t* instance = new game_of_life_t();
+    instance->paletteColours = palette;
+    instance->nColours = nColours;
+    PRINTLOG("The palette has %d colours:\n", nColours);
+    if(instance->nColours > MAX_PALETTE_COLOURS) {
+        PRINTLOG("There are too many colours in the palette. using only the first %d\n", MAX_PALETTE_COLOURS);
+        instance->nColours = MAX_PALETTE_COLOURS;
+    }
+
+    if(LOG_LAYOUT) {
+        for (int i = 0; i < instance->nColours; i++) {
+            PRINTLOG("   %d %d %d\n", palette[i].R, palette[i].G, palette[i].B);
+        }
+    }
+
+    instance->layoutData = layoutData;
+
+    PRINTLOG("The layout has %d panels\n", layoutData->nPanels);
+    if(LOG_LAYOUT) {
+        for (int i = 0; i < layoutData->nPanels; i++) {
+            PRINTLOG("   Id: %d   X, Y: %lf, %lf\n", layoutData->panels[i].panelId,
+                   layoutData->panels[i].shape->getCentroid().x, layoutData->panels[i].shape->getCentroid().y);
+        }
+    }
+
+    // the freqency bin values are seeded from the first few frames so that the plugin starts working reasonably well right away
+    occupancyInit(&instance->occupancy, layoutData->nPanels);
+    prngSeed(&instance->prng, randomSeed);
+    calibrationInit(&instance->calibration, instance->nColours);
+    bandMapperInit(&instance->bandMapper, BAND_MAPPER_FFT_BINS, instance->nColours);
+    lifeGridInit(&instance->grid, layoutData, ADJACENT_PANEL_DISTANCE / LIFE_CELLS_PER_PANEL, LIFE_GRID_MARGIN);
+    buildFootprints(instance);
+    lifeHistoryReset(&instance->history);
+    instance->replayFrames = new Frame_t[LIFE_HISTORY_LENGTH * layoutData->nPanels];
+    if(LIFE_HASHLIFE_NODES > 0) {
+        hashlifeInit(&instance->hashlife, LIFE_HASHLIFE_NODES);
+    }
+    instance->panelColours = new cell_colour_t[layoutData->nPanels]();
+    PRINTLOG("The grid has %d x %d cells\n", instance->grid.width, instance->grid.height);
+    return instance;
+}
+
+int gameOfLifeFftBins(const game_of_life_t* instance)
+{
+    return instance->bandMapper.nFftBins;
+}
+
+
+/**
+  * @description: This function will render the colour of panel p from the live cells around its centroid, and
+  * marks the panel taken or free depending on whether any cell at its centre is alive.
+  */
+static void renderPanel(game_of_life_t* instance, int p, int *returnR, int *returnG, int *returnB)
+{
+    const life_grid_t* grid = &instance->grid;
+    float R = 0;
+    float G = 0;
+    float B = 0;
+    bool taken = false;
+    for(int i = instance->footprintStart[p]; i < instance->footprintStart[p + 1]; i++) {
+        const footprint_t* entry = &instance->footprint[i];
+        if(!lifeGridAlive(grid, entry->x, entry->y)) {
+            continue;
+        }
+        const cell_colour_t* colour = &grid->colours[entry->y * grid->width + entry->x];
+        R += colour->R * entry->weight;
+        G += colour->G * entry->weight;
+        B += colour->B * entry->weight;
+        taken = taken || entry->core;
+    }
+    if(taken) {
+        occupancyTake(&instance->occupancy, p);
+    } else {
+        occupancyRelease(&instance->occupancy, p);
+    }
+    *returnR = std::min((int)(BASE_COLOUR_R + R / LIFE_FULL_WEIGHT), 255);
+    *returnG = std::min((int)(BASE_COLOUR_G + G / LIFE_FULL_WEIGHT), 255);
+    *returnB = std::min((int)(BASE_COLOUR_B + B / LIFE_FULL_WEIGHT), 255);
+}
+
+/**
+  * @description: stop replaying a cycle because the grid is about to change. The grid was left at the start of
+  * the cycle, so it is stepped on to the generation the replay showed last, which is rendered again to bring the
+  * occupancy up to date, and then once more to the generation the replay had reached.
+  */
+static void leaveCycle(game_of_life_t* instance)
+{
+    if(instance->replayPeriod > 0 && instance->replayRecorded == instance->replayPeriod) {
+        int shown = (instance->replayPosition + instance->replayPeriod - 1) % instance->replayPeriod;
+        for(int i = 0; i < shown; i++) {
+            lifeGridStep(&instance->grid);
+        }
+        int R;
+        int G;
+        int B;
+        for(int p = 0; p < instance->layoutData->nPanels; p++) {
+            renderPanel(instance, p, &R, &G, &B);
+        }
+        lifeGridStep(&instance->grid);
+    }
+    instance->replayPeriod = 0;
+    instance->replayRecorded = 0;
+    instance->replayPosition = 0;
+    instance->cycleGenerations = 0;
+    lifeHistoryReset(&instance->history);
+}
+
+/**
+  * @description: bring a random free panel and its neighbours to life in the panel automaton
+  */
+static void addPanelSource(game_of_life_t* instance, cell_colour_t colour)
+{
+    int n1 = occupancyRandomFree(&instance->occupancy, &instance->prng);
+    if(n1 < 0) {
+        n1 = prngBounded(&instance->prng, instance->layoutData->nPanels);
+    }
+    const layout_cache_t* layoutCache = instance->layoutCache;
+    for(int i = layoutCache->adjacencyStart[n1] - 1; i < layoutCache->adjacencyStart[n1 + 1]; i++) {
+        int p = i < layoutCache->adjacencyStart[n1] ? n1 : layoutCache->adjacency[i];
+        automatonSetState(&instance->automaton, p, AUTOMATON_LIVE_STATE);
+        instance->panelColours[p] = colour;
+        occupancyTake(&instance->occupancy, p);
+    }
+}
+
+/**
+  * @description: Spawns a pattern at the centre of a random panel. The frequency band picks the pattern and its
+  * colour, the intensity scales the colour and the orientation is random.
+*/
+static void addSource(game_of_life_t* instance, int paletteIndex, float intensity)
+{
+    // we need at least two panels to do anything meaningful in here
+    if(instance->layoutData->nPanels < 2) {
+        return;
+    }
+    leaveCycle(instance);
+    // decide in the colour of this pattern and factor in the intensity to arrive at an RGB value
+    cell_colour_t colour;
+    colour.R = instance->paletteColours[paletteIndex].R * intensity;
+    colour.G = instance->paletteColours[paletteIndex].G * intensity;
+    colour.B = instance->paletteColours[paletteIndex].B * intensity;
+    if(instance->panelMode) {
+        addPanelSource(instance, colour);
+        return;
+    }
+
+    // pick a random panel with no live cells at its centre, any panel once they all have some
+    int n1 = occupancyRandomFree(&instance->occupancy, &instance->prng);
+    if(n1 < 0) {
+        n1 = prngBounded(&instance->prng, instance->layoutData->nPanels);
+    }
+    const Point& centroid = instance->layoutData->panels[n1].shape->getCentroid();
+    int x;
+    int y;
+    if(!lifeGridCellAt(&instance->grid, centroid.x, centroid.y, &x, &y)) {
+        return;
+    }
+
+    uint32_t mask = lifePatterns[paletteIndex % LIFE_PATTERNS][prngBounded(&instance->prng, LIFE_ORIENTATIONS)];
+    lifeGridStamp(&instance->grid, x - LIFE_PATTERN_SIZE / 2, y - LIFE_PATTERN_SIZE / 2, mask, colour);
+    occupancyTake(&instance->occupancy, n1);
+}
+
+/**
+  * @description: render every panel from its state in the panel automaton and then advance the automaton. A
+  * panel that has just come to life takes the average colour of the live neighbours that woke it.
+  */
+static void panelAutomatonFrame(game_of_life_t* instance, Frame_t* frames)
+{
+    LayoutData* layoutData = instance->layoutData;
+    panel_automaton_t* automaton = &instance->automaton;
+    for(int p = 0; p < layoutData->nPanels; p++) {
+        int state = automatonState(automaton, p);
+        float level = instance->panelRule.level[state];
+        frames[p].panelId = layoutData->panels[p].panelId;
+        frames[p].r = BASE_COLOUR_R + instance->panelColours[p].R * level;
+        frames[p].g = BASE_COLOUR_G + instance->panelColours[p].G * level;
+        frames[p].b = BASE_COLOUR_B + instance->panelColours[p].B * level;
+        frames[p].transTime = TRANSITION_TIME;
+        if(state == instance->panelRule.restState) {
+            occupancyRelease(&instance->occupancy, p);
+        } else {
+            occupancyTake(&instance->occupancy, p);
+        }
+    }
+
+    automatonStep(automaton);
+    const layout_cache_t* layoutCache = instance->layoutCache;
+    for(int p = 0; p < layoutData->nPanels; p++) {
+        if(automatonState(automaton, p) != AUTOMATON_LIVE_STATE || automatonPreviousState(automaton, p) == AUTOMATON_LIVE_STATE) {
+            continue;
+        }
+        int R = 0;
+        int G = 0;
+        int B = 0;
+        int parents = 0;
+        for(int i = layoutCache->adjacencyStart[p]; i < layoutCache->adjacencyStart[p + 1]; i++) {
+            int neighbour = layoutCache->adjacency[i];
+            if(automatonPreviousState(automaton, neighbour) == AUTOMATON_LIVE_STATE) {
+                R += instance->panelColours[neighbour].R;
+                G += instance->panelColours[neighbour].G;
+                B += instance->panelColours[neighbour].B;
+                parents++;
+            }
+        }
+        if(parents > 0) {
+            instance->panelColours[p].R = R / parents;
+            instance->panelColours[p].G = G / parents;
+            instance->panelColours[p].B = B / parents;
+        }
+    }
+}
+
+/**
+  * A simple algorithm to detect beats. It finds a strong signal after a period of quietness.
+  * Actually, it doesn't detect just beats. For example, classical music often doesn't have
+  * strong beats but it has strong instrumental sections. Those would also get detected.
+  */
+static int16_t beat_detector(freq_bin* bin)
+{
+    int16_t beat_detected = 0;
+
+    //Check for local maximum and if observed, add to running average
+    if((bin->soundPower + (bin->runningMax / 4) < bin->previousPower) && (bin->previousPower > bin->secondPreviousPower)){
+        bin->runningMax = addToRunningMax(bin->runningMax, bin->previousPower, 4);
+    }
+
+    // update latest minimum.
+    if(bin->soundPower < bin->latest_minimum) {
+        bin->latest_minimum = bin->soundPower;
+    }
+    else if(bin->latest_minimum > 0) {
+        bin->latest_minimum--;
+    }
+
+    // criteria for a "beat"; value must exceed minimum plus a threshold of the runningMax.
+    if(bin->soundPower > bin->latest_minimum + (bin->runningMax * TRIGGER_THRESHOLD)) {
+        bin->latest_minimum = bin->soundPower;
+        beat_detected = 1;
+    }
+
+    // update historical information
+    bin->secondPreviousPower = bin->previousPower;
+    bin->previousPower = bin->soundPower;
+
+    return beat_detected;
+}
+
+/**
+  * @description: seed the detector of every bin from the levels seen during calibration: the minimum starts at the
+  * noise floor and the running max at the peak level, and the last two frames become the detector's history.
+  */
+static void seedFreqBins(game_of_life_t* instance)
+{
+    const beat_calibration_t* calibration = &instance->calibration;
+    for(int i = 0; i < instance->nColours; i++) {
+        freq_bin* bin = &instance->freq_bins[i];
+        bin->latest_minimum = calibrationNoiseFloor(calibration, i);
+        bin->runningMax = std::max((int)calibrationPeak(calibration, i), 1);
+        bin->maximumTrigger = bin->runningMax;
+        bin->previousPower = calibration->last[i];
+        bin->secondPreviousPower = calibration->secondLast[i];
+    }
+    PRINTLOG("Calibrated after %d frames\n", calibration->frames);
+}
+
+void gameOfLifeFrame(game_of_life_t* instance, const uint8_t* fftBins, Frame_t* frames, int* nFrames)
+{
+    int R;
+    int G;
+    int B;
+    int i;
+    *nFrames = 0;
+
+    // one band per palette colour from the full fft
+    uint8_t bandPowers[MAX_PALETTE_COLOURS];
+    bandMapperApply(&instance->bandMapper, fftBins, bandPowers);
+
+    if(!calibrationDone(&instance->calibration)) {
+        if(calibrationAdd(&instance->calibration, bandPowers)) {
+            seedFreqBins(instance);
+        }
+        return;
+    }
+
+    // Compute the sound power (or volume) in each bin
+    bool fastForward = false;
+    for(i = 0; i < instance->nColours; i++) {
+        freq_bin* bin = &instance->freq_bins[i];
+        bin->soundPower = bandPowers[i];
+        uint8_t beat_detected = beat_detector(bin);
+
+        if(beat_detected) {
+            if (bin->soundPower > bin->maximumTrigger) {
+                bin->maximumTrigger = bin->soundPower;
+            }
+
+            float intensity = 1.0;
+
+            //calculate an intensity ranging from minimum to 1, using log scale
+            if (bin->soundPower > 1 && bin->runningMax > 1){
+                intensity = ((log((float)bin->soundPower) / log((float)bin->runningMax)) * (1.0 - MINIMUM_INTENSITY)) + MINIMUM_INTENSITY;
+            }
+
+            if (intensity > 1.0) {
+                intensity = 1.0;
+            }
+
+            // add a new light source for each beat detected
+            addSource(instance, i, intensity);
+            fastForward = fastForward || intensity >= LIFE_FAST_FORWARD_INTENSITY;
+        }
+
+    }
+    LayoutData* layoutData = instance->layoutData;
+    *nFrames = layoutData->nPanels;
+    if(instance->panelMode) {
+        panelAutomatonFrame(instance, frames);
+        return;
+    }
+
+    if(++instance->framesSinceFastForward >= LIFE_FAST_FORWARD_INTERVAL && fastForward && LIFE_HASHLIFE_NODES > 0) {
+        instance->framesSinceFastForward = 0;
+        leaveCycle(instance);
+        if(!hashlifeAdvance(&instance->hashlife, &instance->grid, LIFE_FAST_FORWARD_LOG2)) {
+            PRINTLOG("The grid is too large to fast forward\n");
+        }
+    }
+
+    // a still life or an oscillator that has stayed put for long enough gets stirred up
+    if(instance->replayPeriod > 0 && ++instance->cycleGenerations > LIFE_RESEED_GENERATIONS &&
+       LIFE_RESEED_GENERATIONS > 0 && instance->nColours > 0 && lifeGridPopulation(&instance->grid) > 0) {
+        PRINTLOG("Reseeding a grid stuck in a cycle of period %d\n", instance->replayPeriod);
+        addSource(instance, prngBounded(&instance->prng, instance->nColours), 1.0);
+    }
+
+    // the whole cycle is recorded, show the next frame of it instead of computing it again
+    if(instance->replayPeriod > 0 && instance->replayRecorded == instance->replayPeriod) {
+        memcpy(frames, &instance->replayFrames[instance->replayPosition * layoutData->nPanels], layoutData->nPanels * sizeof(Frame_t));
+        instance->replayPosition = (instance->replayPosition + 1) % instance->replayPeriod;
+        return;
+    }
+
+    // iterate through all the pals and render each one
+    for(i = 0; i < layoutData->nPanels; i++) {
+        renderPanel(instance, i, &R, &G, &B);
+        frames[i].panelId = layoutData->panels[i].panelId;
+        frames[i].r = R;
+        frames[i].g = G;
+        frames[i].b = B;
+        frames[i].transTime = TRANSITION_TIME;
+    }
+    if(instance->replayPeriod > 0) {
+        memcpy(&instance->replayFrames[instance->replayRecorded * layoutData->nPanels], frames, layoutData->nPanels * sizeof(Frame_t));
+        instance->replayRecorded++;
+    }
+
+    // advance the cells so they are ready for the next frame, and start recording once they repeat
+    lifeGridStep(&instance->grid);
+    int period = lifeHistoryPush(&instance->history, instance->grid.hash);
+    if(period > 0 && instance->replayPeriod == 0) {
+        PRINTLOG("The grid repeats with period %d\n", period);
+        instance->replayPeriod = period;
+    }
+}
+
+bool gameOfLifeSetPanelRule(game_of_life_t* instance, const char* rule)
+{
+    automaton_rule_t panelRule;
+    if(rule != NULL && !automatonParseRule(rule, &panelRule)) {
+        PRINTLOG("Unknown panel rule %s\n", rule);
+        return false;
+    }
+    if(instance->panelMode) {
+        automatonFree(&instance->automaton);
+        instance->panelMode = false;
+    }
+    for(int p = 0; p < instance->layoutData->nPanels; p++) {
+        occupancyRelease(&instance->occupancy, p);
+    }
+    if(rule == NULL) {
+        return true;
+    }
+    if(instance->layoutCache == NULL) {
+        instance->layoutCache = layoutCacheCreate(instance->layoutData, ADJACENT_PANEL_DISTANCE, 1.0, false, NULL);
+    }
+    instance->panelRule = panelRule;
+    automatonInit(&instance->automaton, &panelRule, instance->layoutData->nPanels,
+                  instance->layoutCache->adjacencyStart, instance->layoutCache->adjacency);
+    instance->panelMode = true;
+    PRINTLOG("The panels run %s with %d states\n", rule, panelRule.nStates);
+    return true;
+}
+
+bool gameOfLifeRestoreDetector(game_of_life_t* instance, const char* path)
+{
+    if(path == NULL) {
+        return false;
+    }
+    detector_bin_state_t saved[MAX_PALETTE_COLOURS];
+    float tempo = 0; // the effect does not follow the tempo
+    if(!detectorStateLoad(path, saved, instance->nColours, &tempo)) {
+        return false;
+    }
+    for(int i = 0; i < instance->nColours; i++) {
+        freq_bin* bin = &instance->freq_bins[i];
+        bin->latest_minimum = saved[i].latestMinimum;
+        bin->runningMax = std::max(saved[i].runningMax, (uint32_t)1);
+        bin->maximumTrigger = saved[i].maximumTrigger;
+    }
+    calibrationSkip(&instance->calibration);
+    PRINTLOG("Detector state restored from %s\n", path);
+    return true;
+}
+
+void gameOfLifeSaveDetector(const game_of_life_t* instance, const char* path)
+{
+    if(path == NULL || !calibrationDone(&instance->calibration)) {
+        return; // the constants we started from are not worth keeping
+    }
+    detector_bin_state_t state[MAX_PALETTE_COLOURS];
+    for(int i = 0; i < instance->nColours; i++) {
+        state[i].latestMinimum = instance->freq_bins[i].latest_minimum;
+        state[i].runningMax = instance->freq_bins[i].runningMax;
+        state[i].maximumTrigger = instance->freq_bins[i].maximumTrigger;
+    }
+    detectorStateSave(path, state, instance->nColours, 0);
+}
+
+void gameOfLifeDestroy(game_of_life_t* instance)
+{
+    if(instance == NULL) {
+        return;
+    }
+    calibrationFree(&instance->calibration);
+    bandMapperFree(&instance->bandMapper);
+    occupancyFree(&instance->occupancy);
+    lifeGridFree(&instance->grid);
+    delete [] instance->footprintStart;
+    delete [] instance->footprint;
+    delete [] instance->replayFrames;
+    if(LIFE_HASHLIFE_NODES > 0) {
+        hashlifeFree(&instance->hashlife);
+    }
+    if(instance->panelMode) {
+        automatonFree(&instance->automaton);
+    }
+    layoutCacheDestroy(instance->layoutCache);
+    delete [] instance->panelColours;
+    delete instance;
+}
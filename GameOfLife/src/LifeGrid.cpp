@@ -0,0 +1,266 @@
+/**
+    LifeGrid.cpp
+
+    Description:
+    The bit packed Game of Life grid, see LifeGrid.h.
+    The cell buffers hold one extra empty row above and below the grid, so the rows next to the edge can be
+    read like any other while computing a generation. Only the rows in between are ever written.
+ */
+
+#include "LifeGrid.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+void lifeGridInit(life_grid_t* grid, LayoutData* layoutData, float cellSize, int margin)
+{
+    float minX = 0;
+    float minY = 0;
+    float maxX = 0;
+    float maxY = 0;
+    for(int i = 0; i < layoutData->nPanels; i++) {
+        const Point& centroid = layoutData->panels[i].shape->getCentroid();
+        if(i == 0 || centroid.x < minX) minX = centroid.x;
+        if(i == 0 || centroid.y < minY) minY = centroid.y;
+        if(i == 0 || centroid.x > maxX) maxX = centroid.x;
+        if(i == 0 || centroid.y > maxY) maxY = centroid.y;
+    }
+    grid->cellSize = cellSize;
+    grid->originX = minX - margin * cellSize;
+    grid->originY = minY - margin * cellSize;
+    grid->width = (int)((maxX - minX) / cellSize) + 2 * margin + 1;
+    grid->height = (int)((maxY - minY) / cellSize) + 2 * margin + 1;
+    grid->wordsPerRow = (grid->width + 63) / 64;
+    int words = (grid->height + 2) * grid->wordsPerRow;
+    grid->cells = new uint64_t[words]() + grid->wordsPerRow;
+    grid->next = new uint64_t[words]() + grid->wordsPerRow;
+    grid->colours = new cell_colour_t[grid->width * grid->height]();
+    grid->hash = 0;
+}
+
+void lifeGridFree(life_grid_t* grid)
+{
+    delete [] (grid->cells - grid->wordsPerRow);
+    delete [] (grid->next - grid->wordsPerRow);
+    delete [] grid->colours;
+    grid->cells = NULL;
+    grid->next = NULL;
+    grid->colours = NULL;
+}
+
+bool lifeGridCellAt(const life_grid_t* grid, float x, float y, int* cellX, int* cellY)
+{
+    int cx = (int)floor((x - grid->originX) / grid->cellSize);
+    int cy = (int)floor((y - grid->originY) / grid->cellSize);
+    if(cx < 0 || cy < 0 || cx >= grid->width || cy >= grid->height) {
+        return false;
+    }
+    *cellX = cx;
+    *cellY = cy;
+    return true;
+}
+
+/** The bits of the last word of a row that are inside the grid */
+static uint64_t lastWordMask(const life_grid_t* grid)
+{
+    int used = grid->width & 63;
+    return used == 0 ? ~(uint64_t)0 : ((uint64_t)1 << used) - 1;
+}
+
+void lifeGridStamp(life_grid_t* grid, int left, int top, uint32_t mask, cell_colour_t colour)
+{
+    for(int r = 0; r < 5; r++) {
+        int y = top + r;
+        uint64_t bits = (mask >> (5 * r)) & 0x1F;
+        if(bits == 0 || y < 0 || y >= grid->height) {
+            continue;
+        }
+        int x = left;
+        if(x < 0) {
+            bits = x > -5 ? bits >> -x : 0;
+            x = 0;
+        }
+        if(bits == 0 || x >= grid->width) {
+            continue;
+        }
+        for(uint64_t rest = bits; rest != 0 && x + __builtin_ctzll(rest) < grid->width; rest &= rest - 1) {
+            int cellX = x + __builtin_ctzll(rest);
+            if(!lifeGridAlive(grid, cellX, y)) {
+                grid->hash ^= lifeGridKey(y * grid->width + cellX);
+            }
+            grid->colours[y * grid->width + cellX] = colour;
+        }
+        uint64_t* row = grid->cells + y * grid->wordsPerRow;
+        int word = x >> 6;
+        int shift = x & 63;
+        row[word] |= bits << shift;
+        if(shift > 59 && word + 1 < grid->wordsPerRow) {
+            row[word + 1] |= bits >> (64 - shift);
+        }
+        row[grid->wordsPerRow - 1] &= lastWordMask(grid);
+    }
+}
+
+/** A newborn cell takes the average colour of the three live neighbours that gave birth to it */
+static void colourBirth(life_grid_t* grid, int x, int y)
+{
+    int R = 0;
+    int G = 0;
+    int B = 0;
+    int parents = 0;
+    for(int dy = -1; dy <= 1; dy++) {
+        for(int dx = -1; dx <= 1; dx++) {
+            int nx = x + dx;
+            int ny = y + dy;
+            if((dx == 0 && dy == 0) || nx < 0 || ny < 0 || nx >= grid->width || ny >= grid->height || !lifeGridAlive(grid, nx, ny)) {
+                continue;
+            }
+            const cell_colour_t* parent = &grid->colours[ny * grid->width + nx];
+            R += parent->R;
+            G += parent->G;
+            B += parent->B;
+            parents++;
+        }
+    }
+    cell_colour_t* colour = &grid->colours[y * grid->width + x];
+    colour->R = R / std::max(parents, 1);
+    colour->G = G / std::max(parents, 1);
+    colour->B = B / std::max(parents, 1);
+}
+
+/** Add one neighbour bit plane into the three bit counters, the count is kept modulo 8 */
+static inline void addNeighbours(uint64_t neighbours, uint64_t* s0, uint64_t* s1, uint64_t* s2)
+{
+    uint64_t carry0 = *s0 & neighbours;
+    *s0 ^= neighbours;
+    uint64_t carry1 = *s1 & carry0;
+    *s1 ^= carry0;
+    *s2 ^= carry1;
+}
+
+void lifeGridStep(life_grid_t* grid)
+{
+    const int wordsPerRow = grid->wordsPerRow;
+    const uint64_t lastMask = lastWordMask(grid);
+    for(int y = 0; y < grid->height; y++) {
+        const uint64_t* rows[3] = {grid->cells + (y - 1) * wordsPerRow, grid->cells + y * wordsPerRow, grid->cells + (y + 1) * wordsPerRow};
+        uint64_t* out = grid->next + y * wordsPerRow;
+        for(int k = 0; k < wordsPerRow; k++) {
+            uint64_t s0 = 0;
+            uint64_t s1 = 0;
+            uint64_t s2 = 0;
+            for(int r = 0; r < 3; r++) {
+                uint64_t word = rows[r][k];
+                uint64_t previous = k > 0 ? rows[r][k - 1] : 0;
+                uint64_t following = k + 1 < wordsPerRow ? rows[r][k + 1] : 0;
+                addNeighbours((word << 1) | (previous >> 63), &s0, &s1, &s2);  // the cell to the left
+                addNeighbours((word >> 1) | (following << 63), &s0, &s1, &s2); // the cell to the right
+                if(r != 1) {
+                    addNeighbours(word, &s0, &s1, &s2);
+                }
+            }
+            // 8 neighbours wrap to 0, which dies just like 8 should
+            uint64_t alive = rows[1][k];
+            out[k] = s1 & ~s2 & (s0 | alive);
+        }
+        out[wordsPerRow - 1] &= lastMask;
+    }
+
+    // colour the births while the old generation is still in place, and hash every cell that changed
+    for(int y = 0; y < grid->height; y++) {
+        const uint64_t* oldRow = grid->cells + y * wordsPerRow;
+        const uint64_t* newRow = grid->next + y * wordsPerRow;
+        for(int k = 0; k < wordsPerRow; k++) {
+            uint64_t changed = newRow[k] ^ oldRow[k];
+            while(changed != 0) {
+                int x = k * 64 + __builtin_ctzll(changed);
+                grid->hash ^= lifeGridKey(y * grid->width + x);
+                if(!lifeGridAlive(grid, x, y)) {
+                    colourBirth(grid, x, y);
+                }
+                changed &= changed - 1;
+            }
+        }
+    }
+    std::swap(grid->cells, grid->next);
+}
+
+/** Make a cell's nearest live cell the candidate's if that is nearer */
+static void offerNearest(const life_grid_t* grid, int* nearest, int cell, int candidate)
+{
+    int seed = nearest[candidate];
+    if(seed < 0) {
+        return;
+    }
+    int dx = cell % grid->width - seed % grid->width;
+    int dy = cell / grid->width - seed / grid->width;
+    int current = nearest[cell];
+    if(current >= 0) {
+        int cx = cell % grid->width - current % grid->width;
+        int cy = cell / grid->width - current / grid->width;
+        if(cx * cx + cy * cy <= dx * dx + dy * dy) {
+            return;
+        }
+    }
+    nearest[cell] = seed;
+}
+
+void lifeGridAdopt(life_grid_t* grid)
+{
+    const int width = grid->width;
+    const int height = grid->height;
+    // find the nearest cell alive in the old generation to every cell, with one pass down the grid and one up
+    int* nearest = new int[width * height];
+    for(int y = 0; y < height; y++) {
+        for(int x = 0; x < width; x++) {
+            nearest[y * width + x] = lifeGridAlive(grid, x, y) ? y * width + x : -1;
+        }
+    }
+    for(int y = 0; y < height; y++) {
+        for(int x = 0; x < width; x++) {
+            int cell = y * width + x;
+            if(x > 0) offerNearest(grid, nearest, cell, cell - 1);
+            if(y > 0 && x > 0) offerNearest(grid, nearest, cell, cell - width - 1);
+            if(y > 0) offerNearest(grid, nearest, cell, cell - width);
+            if(y > 0 && x + 1 < width) offerNearest(grid, nearest, cell, cell - width + 1);
+        }
+    }
+    for(int y = height - 1; y >= 0; y--) {
+        for(int x = width - 1; x >= 0; x--) {
+            int cell = y * width + x;
+            if(x + 1 < width) offerNearest(grid, nearest, cell, cell + 1);
+            if(y + 1 < height && x + 1 < width) offerNearest(grid, nearest, cell, cell + width + 1);
+            if(y + 1 < height) offerNearest(grid, nearest, cell, cell + width);
+            if(y + 1 < height && x > 0) offerNearest(grid, nearest, cell, cell + width - 1);
+        }
+    }
+
+    // colour the births and hash every cell that changed
+    for(int y = 0; y < height; y++) {
+        const uint64_t* oldRow = grid->cells + y * grid->wordsPerRow;
+        uint64_t* newRow = grid->next + y * grid->wordsPerRow;
+        newRow[grid->wordsPerRow - 1] &= lastWordMask(grid);
+        for(int k = 0; k < grid->wordsPerRow; k++) {
+            uint64_t changed = newRow[k] ^ oldRow[k];
+            while(changed != 0) {
+                int cell = y * width + k * 64 + __builtin_ctzll(changed);
+                grid->hash ^= lifeGridKey(cell);
+                if(!lifeGridAlive(grid, cell % width, y) && nearest[cell] >= 0) {
+                    grid->colours[cell] = grid->colours[nearest[cell]];
+                }
+                changed &= changed - 1;
+            }
+        }
+    }
+    delete [] nearest;
+    std::swap(grid->cells, grid->next);
+}
+
+int lifeGridPopulation(const life_grid_t* grid)
+{
+    int population = 0;
+    for(int i = 0; i < grid->height * grid->wordsPerRow; i++) {
+        population += __builtin_popcountll(grid->cells[i]);
+    }
+    return population;
+}
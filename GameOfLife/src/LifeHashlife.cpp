@@ -0,0 +1,428 @@
+/**
+    LifeHashlife.cpp
+
+    Description:
+    The memoised quadtree evolution of the Life grid, see LifeHashlife.h.
+    Every node is found through a hash of its four quarters, or of its cells for a leaf, so a block of cells
+    that already has a node never gets a second one.
+ */
+
+#include "LifeHashlife.h"
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+#define LEAF_SIZE (1 << LIFE_HASHLIFE_LEAF_LEVEL)
+#define MIN_ROOT_LEVEL (LIFE_HASHLIFE_LEAF_LEVEL + 2) // keeps the leaves on whole bytes of the grid rows
+#define MAX_AGE 63 // jumps since a node was last used, older nodes all count as this old
+
+static uint32_t nodeHash(const life_hash_node_t* node)
+{
+    uint64_t h;
+    if(node->level == LIFE_HASHLIFE_LEAF_LEVEL) {
+        h = (node->bits ^ (node->bits >> 29)) * 0xBF58476D1CE4E5B9ULL;
+    } else {
+        h = (uint64_t)(uint32_t)node->child[0] * 0x9E3779B97F4A7C15ULL;
+        h = (h ^ (uint32_t)node->child[1]) * 0xBF58476D1CE4E5B9ULL;
+        h = (h ^ (uint32_t)node->child[2]) * 0x94D049BB133111EBULL;
+        h = (h ^ (uint32_t)node->child[3]) * 0x9E3779B97F4A7C15ULL;
+    }
+    return (uint32_t)(h >> 32);
+}
+
+static bool sameNode(const life_hash_node_t* a, const life_hash_node_t* b)
+{
+    if(a->level != b->level) {
+        return false;
+    }
+    if(a->level == LIFE_HASHLIFE_LEAF_LEVEL) {
+        return a->bits == b->bits;
+    }
+    return a->child[0] == b->child[0] && a->child[1] == b->child[1] && a->child[2] == b->child[2] && a->child[3] == b->child[3];
+}
+
+/** The node equal to key, created if there is none yet */
+static int32_t findNode(life_hashlife_t* hashlife, const life_hash_node_t* key)
+{
+    life_hash_node_t* nodes = hashlife->nodes;
+    uint32_t bucket = nodeHash(key) & hashlife->bucketMask;
+    for(int32_t i = hashlife->buckets[bucket]; i >= 0; i = nodes[i].next) {
+        if(sameNode(&nodes[i], key)) {
+            nodes[i].lastUsed = hashlife->clock;
+            return i;
+        }
+    }
+    if(hashlife->freeList < 0) {
+        // the jump is thrown away, any node of the right level will do until it unwinds
+        hashlife->full = true;
+        return hashlife->empty[key->level];
+    }
+    int32_t i = hashlife->freeList;
+    life_hash_node_t* node = &nodes[i];
+    hashlife->freeList = node->next;
+    hashlife->nFree--;
+    *node = *key;
+    node->result = -1;
+    node->resultLog2 = 0;
+    node->lastUsed = hashlife->clock;
+    node->next = hashlife->buckets[bucket];
+    hashlife->buckets[bucket] = i;
+    return i;
+}
+
+static int32_t leaf(life_hashlife_t* hashlife, uint64_t bits)
+{
+    life_hash_node_t key = life_hash_node_t();
+    key.child[0] = key.child[1] = key.child[2] = key.child[3] = -1;
+    key.bits = bits;
+    key.level = LIFE_HASHLIFE_LEAF_LEVEL;
+    key.population = __builtin_popcountll(bits);
+    return findNode(hashlife, &key);
+}
+
+/** The node made of four quarters one level down */
+static int32_t join(life_hashlife_t* hashlife, int32_t nw, int32_t ne, int32_t sw, int32_t se)
+{
+    const life_hash_node_t* nodes = hashlife->nodes;
+    life_hash_node_t key = life_hash_node_t();
+    key.child[0] = nw;
+    key.child[1] = ne;
+    key.child[2] = sw;
+    key.child[3] = se;
+    key.level = nodes[nw].level + 1;
+    key.population = nodes[nw].population + nodes[ne].population + nodes[sw].population + nodes[se].population;
+    return findNode(hashlife, &key);
+}
+
+/** The leaf made of the four 4x4 corners of four leaves that meet in the middle of it */
+static int32_t joinCorners(life_hashlife_t* hashlife, int32_t nw, int32_t ne, int32_t sw, int32_t se)
+{
+    const life_hash_node_t* nodes = hashlife->nodes;
+    uint64_t bits = 0;
+    for(int r = 0; r < 4; r++) {
+        uint64_t top = ((nodes[nw].bits >> ((r + 4) * 8 + 4)) & 0xF) | ((nodes[ne].bits >> ((r + 4) * 8)) & 0xF) << 4;
+        uint64_t bottom = ((nodes[sw].bits >> (r * 8 + 4)) & 0xF) | ((nodes[se].bits >> (r * 8)) & 0xF) << 4;
+        bits |= top << (r * 8) | bottom << ((r + 4) * 8);
+    }
+    return leaf(hashlife, bits);
+}
+
+/** The node made of the south east, south west, north east and north west quarters of four nodes that meet in the middle of it */
+static int32_t joinCentre(life_hashlife_t* hashlife, int32_t nw, int32_t ne, int32_t sw, int32_t se)
+{
+    const life_hash_node_t* nodes = hashlife->nodes;
+    if(nodes[nw].level == LIFE_HASHLIFE_LEAF_LEVEL) {
+        return joinCorners(hashlife, nw, ne, sw, se);
+    }
+    return join(hashlife, nodes[nw].child[3], nodes[ne].child[2], nodes[sw].child[1], nodes[se].child[0]);
+}
+
+/** Mark a node and everything below it as kept */
+static void markTree(life_hashlife_t* hashlife, int32_t root, std::vector<int32_t>* stack)
+{
+    stack->push_back(root);
+    while(!stack->empty()) {
+        int32_t i = stack->back();
+        stack->pop_back();
+        if(hashlife->marks[i]) {
+            continue;
+        }
+        hashlife->marks[i] = 1;
+        if(hashlife->nodes[i].level > LIFE_HASHLIFE_LEAF_LEVEL) {
+            for(int q = 0; q < 4; q++) {
+                stack->push_back(hashlife->nodes[i].child[q]);
+            }
+        }
+    }
+}
+
+/**
+ * Drop the nodes that have gone unused the longest so that at most a quarter of the cache is left, before the
+ * nodes they are made of are added back. Everything but the empty nodes goes if everything is set.
+ */
+static void trimCache(life_hashlife_t* hashlife, bool everything)
+{
+    life_hash_node_t* nodes = hashlife->nodes;
+    int ages[MAX_AGE + 1] = {0};
+    for(int i = 0; i < hashlife->capacity; i++) {
+        if(nodes[i].level >= 0) {
+            ages[std::min(hashlife->clock - nodes[i].lastUsed, (uint32_t)MAX_AGE)]++;
+        }
+    }
+    int keepAge = -1;
+    int kept = 0;
+    while(!everything && keepAge < MAX_AGE && kept + ages[keepAge + 1] <= hashlife->capacity / 4) {
+        keepAge++;
+        kept += ages[keepAge];
+    }
+
+    std::vector<int32_t> stack;
+    memset(hashlife->marks, 0, hashlife->capacity);
+    for(int level = LIFE_HASHLIFE_LEAF_LEVEL; level <= LIFE_HASHLIFE_MAX_LEVEL; level++) {
+        markTree(hashlife, hashlife->empty[level], &stack);
+    }
+    for(int i = 0; i < hashlife->capacity; i++) {
+        if(nodes[i].level >= 0 && (int)(hashlife->clock - nodes[i].lastUsed) <= keepAge) {
+            markTree(hashlife, i, &stack);
+        }
+    }
+
+    // rebuild the hash buckets from the nodes that are kept, the rest become the free list
+    memset(hashlife->buckets, 0xFF, (hashlife->bucketMask + 1) * sizeof(int32_t));
+    hashlife->freeList = -1;
+    hashlife->nFree = 0;
+    for(int32_t i = hashlife->capacity - 1; i >= 0; i--) {
+        life_hash_node_t* node = &nodes[i];
+        if(!hashlife->marks[i]) {
+            node->level = -1;
+            node->next = hashlife->freeList;
+            hashlife->freeList = i;
+            hashlife->nFree++;
+            continue;
+        }
+        if(node->result >= 0 && !hashlife->marks[node->result]) {
+            node->result = -1;
+        }
+        uint32_t bucket = nodeHash(node) & hashlife->bucketMask;
+        node->next = hashlife->buckets[bucket];
+        hashlife->buckets[bucket] = i;
+    }
+}
+
+void hashlifeInit(life_hashlife_t* hashlife, int capacity)
+{
+    hashlife->capacity = std::max(capacity, LIFE_HASHLIFE_MAX_LEVEL + 1);
+    hashlife->nodes = new life_hash_node_t[hashlife->capacity]();
+    uint32_t buckets = 1;
+    while(buckets < (uint32_t)hashlife->capacity) {
+        buckets <<= 1;
+    }
+    hashlife->bucketMask = buckets - 1;
+    hashlife->buckets = new int32_t[buckets];
+    memset(hashlife->buckets, 0xFF, buckets * sizeof(int32_t));
+    hashlife->marks = new uint8_t[hashlife->capacity];
+    hashlife->clock = 0;
+    hashlife->full = false;
+
+    hashlife->freeList = -1;
+    hashlife->nFree = 0;
+    for(int32_t i = hashlife->capacity - 1; i >= 0; i--) {
+        hashlife->nodes[i].level = -1;
+        hashlife->nodes[i].result = -1;
+        hashlife->nodes[i].next = hashlife->freeList;
+        hashlife->freeList = i;
+        hashlife->nFree++;
+    }
+    for(int level = 0; level < LIFE_HASHLIFE_LEAF_LEVEL; level++) {
+        hashlife->empty[level] = -1;
+    }
+    hashlife->empty[LIFE_HASHLIFE_LEAF_LEVEL] = leaf(hashlife, 0);
+    for(int level = LIFE_HASHLIFE_LEAF_LEVEL + 1; level <= LIFE_HASHLIFE_MAX_LEVEL; level++) {
+        int32_t e = hashlife->empty[level - 1];
+        hashlife->empty[level] = join(hashlife, e, e, e, e);
+    }
+}
+
+/** Add one neighbour bit plane into the three bit counters, the count is kept modulo 8 */
+static inline void addNeighbours(uint32_t neighbours, uint32_t* s0, uint32_t* s1, uint32_t* s2)
+{
+    uint32_t carry0 = *s0 & neighbours;
+    *s0 ^= neighbours;
+    uint32_t carry1 = *s1 & carry0;
+    *s1 ^= carry0;
+    *s2 ^= carry1;
+}
+
+/**
+ * The centre 8x8 cells of a 16x16 node made of four leaves, 2^j generations later, j at most 2. Each generation
+ * is computed for the whole block a row at a time; the cells it gets wrong creep in by one cell from the edge
+ * per generation and never reach the centre.
+ */
+static int32_t stepLeaves(life_hashlife_t* hashlife, int32_t m, int j)
+{
+    const life_hash_node_t* nodes = hashlife->nodes;
+    const int32_t* q = nodes[m].child;
+    uint32_t rows[2 * LEAF_SIZE];
+    for(int r = 0; r < LEAF_SIZE; r++) {
+        rows[r] = ((nodes[q[0]].bits >> (r * 8)) & 0xFF) | ((nodes[q[1]].bits >> (r * 8)) & 0xFF) << 8;
+        rows[r + LEAF_SIZE] = ((nodes[q[2]].bits >> (r * 8)) & 0xFF) | ((nodes[q[3]].bits >> (r * 8)) & 0xFF) << 8;
+    }
+    for(int generation = 0; generation < (1 << j); generation++) {
+        uint32_t next[2 * LEAF_SIZE];
+        for(int r = 0; r < 2 * LEAF_SIZE; r++) {
+            uint32_t above = r > 0 ? rows[r - 1] : 0;
+            uint32_t below = r + 1 < 2 * LEAF_SIZE ? rows[r + 1] : 0;
+            uint32_t s0 = 0;
+            uint32_t s1 = 0;
+            uint32_t s2 = 0;
+            addNeighbours(above << 1, &s0, &s1, &s2);
+            addNeighbours(above, &s0, &s1, &s2);
+            addNeighbours(above >> 1, &s0, &s1, &s2);
+            addNeighbours(rows[r] << 1, &s0, &s1, &s2);
+            addNeighbours(rows[r] >> 1, &s0, &s1, &s2);
+            addNeighbours(below << 1, &s0, &s1, &s2);
+            addNeighbours(below, &s0, &s1, &s2);
+            addNeighbours(below >> 1, &s0, &s1, &s2);
+            next[r] = s1 & ~s2 & (s0 | rows[r]) & 0xFFFF;
+        }
+        memcpy(rows, next, sizeof(rows));
+    }
+    uint64_t bits = 0;
+    for(int r = 0; r < LEAF_SIZE; r++) {
+        bits |= (uint64_t)((rows[r + LEAF_SIZE / 2] >> (LEAF_SIZE / 2)) & 0xFF) << (r * 8);
+    }
+    return leaf(hashlife, bits);
+}
+
+/**
+ * The centre half of node m, 2^j generations later. j has to be at most the level of m minus 2, which is as far
+ * as anything outside m can reach into the centre.
+ */
+static int32_t successor(life_hashlife_t* hashlife, int32_t m, int j)
+{
+    life_hash_node_t* nodes = hashlife->nodes;
+    int level = nodes[m].level;
+    if(hashlife->full || nodes[m].population == 0) {
+        return hashlife->empty[level - 1];
+    }
+    if(nodes[m].result >= 0 && nodes[m].resultLog2 == j) {
+        nodes[m].lastUsed = hashlife->clock;
+        return nodes[m].result;
+    }
+    int32_t result;
+    if(level == LIFE_HASHLIFE_LEAF_LEVEL + 1) {
+        result = stepLeaves(hashlife, m, j);
+    } else {
+        // the nine overlapping sub-squares of half the size, each moved on by up to 2^(level - 3) generations
+        int firstLog2 = std::min(j, level - 3);
+        const int32_t* q = nodes[m].child;
+        int32_t sub[9];
+        sub[0] = q[0];
+        sub[2] = q[1];
+        sub[6] = q[2];
+        sub[8] = q[3];
+        const int32_t* nw = nodes[q[0]].child;
+        const int32_t* ne = nodes[q[1]].child;
+        const int32_t* sw = nodes[q[2]].child;
+        const int32_t* se = nodes[q[3]].child;
+        sub[1] = join(hashlife, nw[1], ne[0], nw[3], ne[2]);
+        sub[3] = join(hashlife, nw[2], nw[3], sw[0], sw[1]);
+        sub[4] = join(hashlife, nw[3], ne[2], sw[1], se[0]);
+        sub[5] = join(hashlife, ne[2], ne[3], se[0], se[1]);
+        sub[7] = join(hashlife, sw[1], se[0], sw[3], se[2]);
+        int32_t c[9];
+        for(int i = 0; i < 9; i++) {
+            c[i] = successor(hashlife, sub[i], firstLog2);
+        }
+        if(j < level - 2) {
+            // they have come far enough, put their centres together
+            result = join(hashlife,
+                joinCentre(hashlife, c[0], c[1], c[3], c[4]),
+                joinCentre(hashlife, c[1], c[2], c[4], c[5]),
+                joinCentre(hashlife, c[3], c[4], c[6], c[7]),
+                joinCentre(hashlife, c[4], c[5], c[7], c[8]));
+        } else {
+            // and as far again for the four squares they make up
+            result = join(hashlife,
+                successor(hashlife, join(hashlife, c[0], c[1], c[3], c[4]), firstLog2),
+                successor(hashlife, join(hashlife, c[1], c[2], c[4], c[5]), firstLog2),
+                successor(hashlife, join(hashlife, c[3], c[4], c[6], c[7]), firstLog2),
+                successor(hashlife, join(hashlife, c[4], c[5], c[7], c[8]), firstLog2));
+        }
+    }
+    if(!hashlife->full) {
+        nodes[m].result = result;
+        nodes[m].resultLog2 = j;
+    }
+    return result;
+}
+
+/** The node for the grid cells in the square of 2^level cells with its corner at (x, y), x a multiple of 8 */
+static int32_t buildNode(life_hashlife_t* hashlife, const life_grid_t* grid, int level, int x, int y)
+{
+    int size = 1 << level;
+    if(x >= grid->width || y >= grid->height || x + size <= 0 || y + size <= 0) {
+        return hashlife->empty[level];
+    }
+    if(level == LIFE_HASHLIFE_LEAF_LEVEL) {
+        uint64_t bits = 0;
+        for(int r = 0; r < LEAF_SIZE; r++) {
+            if(y + r >= 0 && y + r < grid->height) {
+                uint64_t word = grid->cells[(y + r) * grid->wordsPerRow + (x >> 6)];
+                bits |= ((word >> (x & 63)) & 0xFF) << (r * 8);
+            }
+        }
+        return leaf(hashlife, bits);
+    }
+    int half = size / 2;
+    int32_t nw = buildNode(hashlife, grid, level - 1, x, y);
+    int32_t ne = buildNode(hashlife, grid, level - 1, x + half, y);
+    int32_t sw = buildNode(hashlife, grid, level - 1, x, y + half);
+    int32_t se = buildNode(hashlife, grid, level - 1, x + half, y + half);
+    return join(hashlife, nw, ne, sw, se);
+}
+
+/** Set the live cells of node m, with its corner at (x, y), in grid->next */
+static void writeNode(const life_hashlife_t* hashlife, life_grid_t* grid, int32_t m, int x, int y)
+{
+    const life_hash_node_t* node = &hashlife->nodes[m];
+    int size = 1 << node->level;
+    if(node->population == 0 || x >= grid->width || y >= grid->height || x + size <= 0 || y + size <= 0) {
+        return;
+    }
+    if(node->level == LIFE_HASHLIFE_LEAF_LEVEL) {
+        for(int r = 0; r < LEAF_SIZE && y + r < grid->height; r++) {
+            if(y + r >= 0) {
+                grid->next[(y + r) * grid->wordsPerRow + (x >> 6)] |= ((node->bits >> (r * 8)) & 0xFF) << (x & 63);
+            }
+        }
+        return;
+    }
+    int half = size / 2;
+    writeNode(hashlife, grid, node->child[0], x, y);
+    writeNode(hashlife, grid, node->child[1], x + half, y);
+    writeNode(hashlife, grid, node->child[2], x, y + half);
+    writeNode(hashlife, grid, node->child[3], x + half, y + half);
+}
+
+bool hashlifeAdvance(life_hashlife_t* hashlife, life_grid_t* grid, int log2Generations)
+{
+    // the grid sits in the centre half of the root, with at least 2^log2Generations cells of room around it
+    int gridLevel = 0;
+    while((1 << gridLevel) < std::max(grid->width, grid->height)) {
+        gridLevel++;
+    }
+    int level = std::max(std::max(gridLevel + 1, log2Generations + 2), MIN_ROOT_LEVEL);
+    if(level > LIFE_HASHLIFE_MAX_LEVEL) {
+        return false;
+    }
+    int margin = 1 << (level - 2);
+
+    hashlife->clock++;
+    if(hashlife->nFree < hashlife->capacity / 2) {
+        trimCache(hashlife, false);
+    }
+    for(int attempt = 0; attempt < 2; attempt++) {
+        hashlife->full = false;
+        int32_t root = buildNode(hashlife, grid, level, -margin, -margin);
+        int32_t result = successor(hashlife, root, log2Generations);
+        if(!hashlife->full) {
+            memset(grid->next, 0, grid->height * grid->wordsPerRow * sizeof(uint64_t));
+            writeNode(hashlife, grid, result, 0, 0);
+            lifeGridAdopt(grid);
+            return true;
+        }
+        trimCache(hashlife, true);
+    }
+    return false;
+}
+
+void hashlifeFree(life_hashlife_t* hashlife)
+{
+    delete [] hashlife->nodes;
+    delete [] hashlife->buckets;
+    delete [] hashlife->marks;
+    hashlife->nodes = NULL;
+    hashlife->buckets = NULL;
+    hashlife->marks = NULL;
+}
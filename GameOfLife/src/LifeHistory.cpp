@@ -0,0 +1,32 @@
+/**
+    LifeHistory.cpp
+
+    Description:
+    The ring of recent generation hashes, see LifeHistory.h.
+ */
+
+#include "LifeHistory.h"
+
+void lifeHistoryReset(life_history_t* history)
+{
+    history->next = 0;
+    history->count = 0;
+}
+
+int lifeHistoryPush(life_history_t* history, uint64_t hash)
+{
+    int period = 0;
+    for(int p = 1; p <= history->count; p++) {
+        int slot = (history->next - p + LIFE_HISTORY_LENGTH) % LIFE_HISTORY_LENGTH;
+        if(history->hashes[slot] == hash) {
+            period = p;
+            break;
+        }
+    }
+    history->hashes[history->next] = hash;
+    history->next = (history->next + 1) % LIFE_HISTORY_LENGTH;
+    if(history->count < LIFE_HISTORY_LENGTH) {
+        history->count++;
+    }
+    return period;
+}
@@ -0,0 +1,180 @@
+/**
+    PanelAutomaton.cpp
+
+    Description:
+    The table driven automata on the panel graph, see PanelAutomaton.h.
+    The rule is only ever looked at while the table is filled in; automatonStep() does not know which rule it runs.
+ */
+
+#include "PanelAutomaton.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <algorithm>
+
+// The named rules and what they stand for
+static const char* const namedRules[][2] = {
+    { "Life", "B3/S23" },
+    { "BriansBrain", "B2/S/C3" },
+    { "StarWars", "B2/S345/C4" },
+};
+
+// Wireworld's states
+#define WIRE_EMPTY 0
+#define WIRE_HEAD AUTOMATON_LIVE_STATE
+#define WIRE_TAIL 2
+#define WIRE_CONDUCTOR 3
+
+/** Read the neighbour counts after a B or an S into a bit mask, up to the next '/' */
+static const char* parseCounts(const char* text, uint32_t* counts)
+{
+    *counts = 0;
+    while(*text >= '0' && *text <= '9') {
+        *counts |= 1u << (*text - '0');
+        text++;
+    }
+    return text;
+}
+
+bool automatonParseRule(const char* text, automaton_rule_t* rule)
+{
+    memset(rule, 0, sizeof(*rule));
+    rule->nCounted = 1;
+    if(strcasecmp(text, "Wireworld") == 0) {
+        rule->family = AUTOMATON_WIREWORLD;
+        rule->nStates = 4;
+        rule->restState = WIRE_CONDUCTOR;
+        rule->counted[0] = WIRE_HEAD;
+        rule->level[WIRE_HEAD] = 1.0;
+        rule->level[WIRE_TAIL] = 0.4;
+        return true;
+    }
+    for(size_t i = 0; i < sizeof(namedRules) / sizeof(namedRules[0]); i++) {
+        if(strcasecmp(text, namedRules[i][0]) == 0) {
+            text = namedRules[i][1];
+        }
+    }
+
+    // B<counts>/S<counts>[/C<states>]
+    rule->family = AUTOMATON_GENERATIONS;
+    rule->nStates = 2;
+    rule->restState = 0;
+    rule->counted[0] = AUTOMATON_LIVE_STATE;
+    if(*text != 'B' && *text != 'b') {
+        return false;
+    }
+    text = parseCounts(text + 1, &rule->birth);
+    if(text[0] != '/' || (text[1] != 'S' && text[1] != 's')) {
+        return false;
+    }
+    text = parseCounts(text + 2, &rule->survive);
+    if(text[0] == '/' && (text[1] == 'C' || text[1] == 'c')) {
+        char* end;
+        rule->nStates = strtol(text + 2, &end, 10);
+        text = end;
+    }
+    if(*text != '\0' || rule->nStates < 2 || rule->nStates > AUTOMATON_MAX_STATES || (rule->birth & 1)) {
+        return false; // a rule where nothing is born from nothing would light up every panel at once
+    }
+    // live panels are at full brightness and the dying ones fade out
+    for(int s = AUTOMATON_LIVE_STATE; s < rule->nStates; s++) {
+        rule->level[s] = (float)(rule->nStates - s) / (rule->nStates - AUTOMATON_LIVE_STATE);
+    }
+    return true;
+}
+
+/** The state a panel in state goes to with counts[k] neighbours in state rule->counted[k] */
+static int ruleNext(const automaton_rule_t* rule, int state, const int* counts)
+{
+    int heads = counts[0];
+    switch(rule->family) {
+    case AUTOMATON_WIREWORLD:
+        if(state == WIRE_HEAD) return WIRE_TAIL;
+        if(state == WIRE_TAIL) return WIRE_CONDUCTOR;
+        if(state == WIRE_CONDUCTOR) return heads == 1 || heads == 2 ? WIRE_HEAD : WIRE_CONDUCTOR;
+        return WIRE_EMPTY;
+    case AUTOMATON_GENERATIONS:
+    default:
+        if(state == 0) return heads < 32 && ((rule->birth >> heads) & 1) ? AUTOMATON_LIVE_STATE : 0;
+        if(state == AUTOMATON_LIVE_STATE && heads < 32 && ((rule->survive >> heads) & 1)) return AUTOMATON_LIVE_STATE;
+        return (state + 1) % rule->nStates;
+    }
+}
+
+void automatonInit(panel_automaton_t* automaton, const automaton_rule_t* rule, int nPanels, const int* adjacencyStart, const int* adjacency)
+{
+    automaton->nPanels = nPanels;
+    automaton->adjacencyStart = adjacencyStart;
+    automaton->adjacency = adjacency;
+    automaton->bitsPerState = rule->nStates <= 4 ? 2 : 4;
+
+    // counts go up to the most neighbours any panel has, so they are digits in base maxDegree + 1
+    int maxDegree = 0;
+    for(int p = 0; p < nPanels; p++) {
+        maxDegree = std::max(maxDegree, adjacencyStart[p + 1] - adjacencyStart[p]);
+    }
+    int radix = maxDegree + 1;
+    automaton->stride = 1;
+    memset(automaton->weight, 0, sizeof(automaton->weight));
+    for(int k = 0; k < rule->nCounted; k++) {
+        automaton->weight[rule->counted[k]] = automaton->stride;
+        automaton->stride *= radix;
+    }
+    automaton->table = new uint8_t[rule->nStates * automaton->stride];
+    for(int state = 0; state < rule->nStates; state++) {
+        for(int index = 0; index < automaton->stride; index++) {
+            int counts[AUTOMATON_MAX_COUNTED];
+            for(int k = 0, rest = index; k < rule->nCounted; k++, rest /= radix) {
+                counts[k] = rest % radix;
+            }
+            automaton->table[state * automaton->stride + index] = ruleNext(rule, state, counts);
+        }
+    }
+
+    int words = (nPanels * automaton->bitsPerState + 63) / 64;
+    automaton->states = new uint64_t[words]();
+    automaton->previous = new uint64_t[words]();
+    for(int p = 0; p < nPanels; p++) {
+        automatonSetState(automaton, p, rule->restState);
+    }
+    memcpy(automaton->previous, automaton->states, words * sizeof(uint64_t));
+}
+
+void automatonSetState(panel_automaton_t* automaton, int panel, int state)
+{
+    int bit = panel * automaton->bitsPerState;
+    uint64_t mask = (((uint64_t)1 << automaton->bitsPerState) - 1) << (bit & 63);
+    uint64_t* word = &automaton->states[bit >> 6];
+    *word = (*word & ~mask) | ((uint64_t)state << (bit & 63));
+}
+
+void automatonStep(panel_automaton_t* automaton)
+{
+    const int bitsPerState = automaton->bitsPerState;
+    const int perWord = 64 / bitsPerState;
+    const uint64_t* states = automaton->states;
+    uint64_t* next = automaton->previous;
+    for(int first = 0; first < automaton->nPanels; first += perWord) {
+        uint64_t word = 0;
+        int last = std::min(first + perWord, automaton->nPanels);
+        for(int p = first; p < last; p++) {
+            int index = automatonWordState(states, bitsPerState, p) * automaton->stride;
+            for(int i = automaton->adjacencyStart[p]; i < automaton->adjacencyStart[p + 1]; i++) {
+                index += automaton->weight[automatonWordState(states, bitsPerState, automaton->adjacency[i])];
+            }
+            word |= (uint64_t)automaton->table[index] << ((p - first) * bitsPerState);
+        }
+        next[first / perWord] = word;
+    }
+    std::swap(automaton->states, automaton->previous);
+}
+
+void automatonFree(panel_automaton_t* automaton)
+{
+    delete [] automaton->table;
+    delete [] automaton->states;
+    delete [] automaton->previous;
+    automaton->table = NULL;
+    automaton->states = NULL;
+    automaton->previous = NULL;
+}
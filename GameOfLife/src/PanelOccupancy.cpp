@@ -0,0 +1,65 @@
+/**
+    PanelOccupancy.cpp
+
+    Description:
+    Occupancy bitmap and free panel list, see PanelOccupancy.h.
+ */
+
+#include "PanelOccupancy.h"
+#include <stddef.h>
+
+void occupancyInit(panel_occupancy_t* occupancy, int nPanels)
+{
+    occupancy->nPanels = nPanels > 0 ? nPanels : 0;
+    occupancy->taken = new uint64_t[(occupancy->nPanels + 63) / 64 + 1]();
+    occupancy->freePanels = new int[occupancy->nPanels + 1];
+    occupancy->freeSlot = new int[occupancy->nPanels + 1];
+    for(int p = 0; p < occupancy->nPanels; p++) {
+        occupancy->freePanels[p] = p;
+        occupancy->freeSlot[p] = p;
+    }
+    occupancy->nFree = occupancy->nPanels;
+}
+
+void occupancyTake(panel_occupancy_t* occupancy, int panel)
+{
+    if(occupancyIsTaken(occupancy, panel)) {
+        return;
+    }
+    occupancy->taken[panel >> 6] |= (uint64_t)1 << (panel & 63);
+    // move the last free panel into the slot of the one taken
+    int slot = occupancy->freeSlot[panel];
+    int last = occupancy->freePanels[--occupancy->nFree];
+    occupancy->freePanels[slot] = last;
+    occupancy->freeSlot[last] = slot;
+}
+
+void occupancyRelease(panel_occupancy_t* occupancy, int panel)
+{
+    if(!occupancyIsTaken(occupancy, panel)) {
+        return;
+    }
+    occupancy->taken[panel >> 6] &= ~((uint64_t)1 << (panel & 63));
+    occupancy->freeSlot[panel] = occupancy->nFree;
+    occupancy->freePanels[occupancy->nFree++] = panel;
+}
+
+int occupancyRandomFree(const panel_occupancy_t* occupancy, prng_t* prng)
+{
+    if(occupancy->nFree == 0) {
+        return -1;
+    }
+    return occupancy->freePanels[prngBounded(prng, occupancy->nFree)];
+}
+
+void occupancyFree(panel_occupancy_t* occupancy)
+{
+    delete [] occupancy->taken;
+    delete [] occupancy->freePanels;
+    delete [] occupancy->freeSlot;
+    occupancy->taken = NULL;
+    occupancy->freePanels = NULL;
+    occupancy->freeSlot = NULL;
+    occupancy->nPanels = 0;
+    occupancy->nFree = 0;
+}
@@ -0,0 +1,61 @@
+/**
+    Prng.cpp
+
+    Description:
+    Seeding and the bounded integer helpers of the per instance generator, see Prng.h.
+    Bounded integers use Lemire's multiply and shift method: the top 32 bits of a 32 x 32 bit product are
+    uniform in [0, bound) once the few low products that would bias them are rejected, which needs a
+    division only on the rare rejection path.
+ */
+
+#include "Prng.h"
+
+/** splitmix64, spreads a seed over the whole state */
+static uint64_t splitmix64(uint64_t* x)
+{
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void prngSeed(prng_t* prng, uint64_t seed)
+{
+    for(int i = 0; i < 4; i++) {
+        prng->s[i] = splitmix64(&seed);
+    }
+}
+
+uint32_t prngBounded(prng_t* prng, uint32_t bound)
+{
+    uint64_t product = (prngNext(prng) >> 32) * bound;
+    uint32_t low = (uint32_t)product;
+    if(low < bound) {
+        uint32_t threshold = -bound % bound;
+        while(low < threshold) {
+            product = (prngNext(prng) >> 32) * bound;
+            low = (uint32_t)product;
+        }
+    }
+    return product >> 32;
+}
+
+void prngFill(prng_t* prng, uint32_t* values, int n, uint32_t bound)
+{
+    int i = 0;
+    if(bound == 0) {
+        // two words per draw
+        for(; i + 1 < n; i += 2) {
+            uint64_t bits = prngNext(prng);
+            values[i] = (uint32_t)(bits >> 32);
+            values[i + 1] = (uint32_t)bits;
+        }
+        if(i < n) {
+            values[i] = (uint32_t)(prngNext(prng) >> 32);
+        }
+        return;
+    }
+    for(; i < n; i++) {
+        values[i] = prngBounded(prng, bound);
+    }
+}
@@ -4,20 +4,44 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 CPP_SRCS += \
-../src/AuroraPlugin.cpp 
+../src/AuroraPlugin.cpp \
+../src/LayoutCache.cpp \
+../src/MovingLightSource.cpp \
+../src/SplatRenderer.cpp \
+../src/BeatCalibration.cpp \
+../src/DetectorState.cpp \
+../src/BandMapper.cpp \
+../src/Prng.cpp \
+../src/ParticleSystem.cpp 
 
 OBJS += \
-./src/AuroraPlugin.o 
+./src/AuroraPlugin.o \
+./src/LayoutCache.o \
+./src/MovingLightSource.o \
+./src/SplatRenderer.o \
+./src/BeatCalibration.o \
+./src/DetectorState.o \
+./src/BandMapper.o \
+./src/Prng.o \
+./src/ParticleSystem.o 
 
 CPP_DEPS += \
-./src/AuroraPlugin.d 
+./src/AuroraPlugin.d \
+./src/LayoutCache.d \
+./src/MovingLightSource.d \
+./src/SplatRenderer.d \
+./src/BeatCalibration.d \
+./src/DetectorState.d \
+./src/BandMapper.d \
+./src/Prng.d \
+./src/ParticleSystem.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
 src/%.o: ../src/%.cpp
 	@echo 'Building file: $<'
 	@echo 'Invoking: Cross G++ Compiler'
-	g++ -I../inc -O0 -g3 -Wall -c -fmessage-length=0 -std=c++11 -fPIC -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	g++ -I../inc -O0 -g3 -Wall -c -fmessage-length=0 -std=c++11 -pthread -fPIC -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
 	@echo 'Finished building: $<'
 	@echo ' '
 
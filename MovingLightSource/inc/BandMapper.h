@@ -0,0 +1,49 @@
+/**
+    BandMapper.h
+
+    Description:
+    Maps a fixed size fft onto however many frequency bands the palette asks for. The plugins used to call
+    enableFft(nColors), so the spectrum was only as fine as the palette was long and a two colour palette
+    got a two bin fft. Instead the host is asked for BAND_MAPPER_FFT_BINS bins and every band is a weighted
+    average of the bins it covers. The bands are spaced logarithmically in frequency, like the ear hears them,
+    so the low bands are a fraction of a bin wide and the top band spans many bins.
+
+    The weights are computed once and kept as a sparse matrix: for each band the bins it touches and their
+    weights in 1/65536ths, summing to 65536. A band power stays on the same 0-255 scale as an fft bin, so the
+    beat detector thresholds do not depend on the number of bands.
+ */
+
+#ifndef INC_BANDMAPPER_H_
+#define INC_BANDMAPPER_H_
+
+#include <stdint.h>
+
+#define BAND_MAPPER_FFT_BINS 32 // fft resolution requested from the host, whatever the palette size
+#define BAND_WEIGHT_ONE 65536 // the weights of a band add up to this
+
+typedef struct {
+    int nFftBins;
+    int nBands;
+    int* bandStart;             // the weights of band b are entries bandStart[b] up to bandStart[b + 1]
+    uint16_t* bin;              // fft bin of each entry
+    uint32_t* weight;           // weight of each entry in 1/BAND_WEIGHT_ONE
+} band_mapper_t;
+
+/**
+ * @description: compute the weights mapping nFftBins fft bins onto nBands log spaced bands
+ */
+void bandMapperInit(band_mapper_t* mapper, int nFftBins, int nBands);
+
+/**
+ * @description: compute the power of every band for one frame
+ * @param fftBins: nFftBins bins from the host
+ * @param bands: filled with nBands band powers
+ */
+void bandMapperApply(const band_mapper_t* mapper, const uint8_t* fftBins, uint8_t* bands);
+
+/**
+ * @description: free the weights
+ */
+void bandMapperFree(band_mapper_t* mapper);
+
+#endif /* INC_BANDMAPPER_H_ */
@@ -0,0 +1,71 @@
+/**
+    BeatCalibration.h
+
+    Description:
+    Warm-up calibration for the beat detector. Instead of throwing away the first frames after the plugin is
+    loaded and starting every frequency bin from the same constants, the first CALIBRATION_FRAMES frames of
+    fft data are collected in a small histogram per bin. The noise floor and the peak level of each bin are
+    then read back as percentiles, which ignore the odd outlier frame, and used to seed the detector.
+    The histograms are a fixed CALIBRATION_BUCKETS counters per bin whatever the number of frames.
+ */
+
+#ifndef INC_BEATCALIBRATION_H_
+#define INC_BEATCALIBRATION_H_
+
+#include <stdint.h>
+
+#define CALIBRATION_FRAMES 8 // frames collected before detection starts, about 400ms at the usual 50ms frame interval
+#define CALIBRATION_BUCKET_SHIFT 3 // each histogram bucket covers 8 fft levels
+#define CALIBRATION_BUCKETS (256 >> CALIBRATION_BUCKET_SHIFT)
+#define CALIBRATION_FLOOR_PERCENTILE 10 // the level of the quiet frames
+#define CALIBRATION_PEAK_PERCENTILE 90 // the level of the loud frames
+
+typedef struct {
+    uint16_t counts[CALIBRATION_BUCKETS];
+} level_histogram_t;
+
+typedef struct {
+    level_histogram_t* bins;
+    int nBins;
+    int frames;                 // frames collected so far
+    uint8_t* last;              // the last two frames of every bin, to carry the detector's history over
+    uint8_t* secondLast;
+} beat_calibration_t;
+
+/**
+ * @description: start collecting for nBins fft bins
+ */
+void calibrationInit(beat_calibration_t* calibration, int nBins);
+
+/**
+ * @description: add the fft bins of one frame
+ * @return: true once CALIBRATION_FRAMES frames have been collected
+ */
+bool calibrationAdd(beat_calibration_t* calibration, const uint8_t* fftBins);
+
+/**
+ * @description: true once CALIBRATION_FRAMES frames have been collected
+ */
+bool calibrationDone(const beat_calibration_t* calibration);
+
+/**
+ * @description: mark the calibration done without collecting, for a detector seeded some other way
+ */
+void calibrationSkip(beat_calibration_t* calibration);
+
+/**
+ * @description: the noise floor of a bin, the CALIBRATION_FLOOR_PERCENTILE level
+ */
+uint8_t calibrationNoiseFloor(const beat_calibration_t* calibration, int bin);
+
+/**
+ * @description: the peak level of a bin, the CALIBRATION_PEAK_PERCENTILE level
+ */
+uint8_t calibrationPeak(const beat_calibration_t* calibration, int bin);
+
+/**
+ * @description: free the histograms
+ */
+void calibrationFree(beat_calibration_t* calibration);
+
+#endif /* INC_BEATCALIBRATION_H_ */
@@ -0,0 +1,59 @@
+/**
+    MovingLightSource.h
+
+    Description:
+    The MovingLightSource effect as a self contained instance. The light sources, the frequency bin history,
+    the beat detector calibration and the colours last sent to the panels hang off a moving_light_source_t
+    instead of file statics, and the instance never calls into the host: the fft bins of a frame are handed in
+    by the caller. AuroraPlugin.cpp keeps one instance behind the initPlugin/getPluginFrame/pluginCleanup ABI,
+    the simulator and benchmarks can create as many as they like.
+ */
+
+#ifndef INC_MOVINGLIGHTSOURCE_H_
+#define INC_MOVINGLIGHTSOURCE_H_
+
+#include <stdint.h>
+#include "AuroraPlugin.h"
+#include "ColorUtils.h"
+#include "LayoutProcessingUtils.h"
+
+struct moving_light_source_t;
+
+/**
+ * @description: create an instance for a layout and palette. Both have to outlive the instance.
+ * @param randomSeed: seeds the instance's random numbers, the same seed replays the same run
+ */
+moving_light_source_t* movingLightSourceCreate(LayoutData* layoutData, RGB_t* palette, int nColours, uint64_t randomSeed);
+
+/**
+ * @description: number of fft bins movingLightSourceFrame() reads
+ */
+int movingLightSourceFftBins(const moving_light_source_t* instance);
+
+/**
+ * @description: launch a light source for every beat, render the panels around the light sources and move them one step
+ * @param fftBins: movingLightSourceFftBins() bins sampled from the host for this frame
+ * @param frames: buffer with room for one frame per panel, only the panels that changed colour are written
+ * @param nFrames: filled with the number of frames written
+ */
+void movingLightSourceFrame(moving_light_source_t* instance, const uint8_t* fftBins, Frame_t* frames, int* nFrames);
+
+/**
+ * @description: seed the beat detector from a state saved by movingLightSourceSaveDetector(), skipping the
+ * calibration. Call it right after movingLightSourceCreate(). A NULL path is ignored.
+ * @return: true if the state was recent enough and saved for the same number of fft bins
+ */
+bool movingLightSourceRestoreDetector(moving_light_source_t* instance, const char* path);
+
+/**
+ * @description: save what the beat detector has learnt so the next instance can start from it. Nothing is
+ * written before the detector has been calibrated or when path is NULL.
+ */
+void movingLightSourceSaveDetector(const moving_light_source_t* instance, const char* path);
+
+/**
+ * @description: free the instance and everything it allocated. NULL is ignored.
+ */
+void movingLightSourceDestroy(moving_light_source_t* instance);
+
+#endif /* INC_MOVINGLIGHTSOURCE_H_ */
@@ -0,0 +1,74 @@
+/**
+    ParticleSystem.h
+
+    Description:
+    Light sources that fly over the layout. Every particle has a position, a velocity, a colour and a life in
+    frames, each kept in its own array so a step moves four particles at a time with GCC vector types, which
+    become SSE or NEON.
+
+    The particles stay inside the convex hull of the panels: the hull is built once when the system is made,
+    padded by a margin around every centroid, and kept as a list of edges with outward normals. A particle that
+    ends a step outside an edge is mirrored back across it and its velocity reflected, so it bounces. The
+    bounce is folded into the arithmetic with comparison masks, there is no branch per particle. Four particles
+    that are all within a circle inside the hull skip the edges altogether, which is most of them on large layouts.
+ */
+
+#ifndef INC_PARTICLESYSTEM_H_
+#define INC_PARTICLESYSTEM_H_
+
+#include <stdint.h>
+#include <float.h>
+#include "LayoutCache.h"
+
+#define PARTICLE_LANES 4 // particles moved at once
+#define PARTICLE_IMMORTAL FLT_MAX // a particle spawned with this life never dies
+
+// four consecutive particles of one of the arrays
+typedef float particle_lanes_t __attribute__((vector_size(PARTICLE_LANES * sizeof(float)), aligned(4), may_alias));
+typedef int32_t particle_select_t __attribute__((vector_size(PARTICLE_LANES * sizeof(int32_t))));
+
+typedef struct {
+    int capacity;               // particles there is room for, the arrays are padded to whole vectors past it
+    int count;                  // live particles, they are the first count entries of every array
+    float* x;
+    float* y;
+    float* vx;                  // layout units per frame
+    float* vy;
+    float* R;
+    float* G;
+    float* B;
+    float* life;                // frames left, a particle dies once this reaches 0
+    int nEdges;                 // the hull: a point p is inside when edgeX * p.x + edgeY * p.y <= edgeOffset for every edge
+    float* edgeX;               // outward normal of each edge
+    float* edgeY;
+    float* edgeOffset;
+    float centreX;              // the centre of the hull's vertices
+    float centreY;
+    float innerRadius2;         // a particle closer than this squared to the centre is inside every edge
+} particle_system_t;
+
+/**
+ * @description: make an empty system whose particles bounce around the panels of a layout
+ * @param margin: how far past the centroids the hull reaches, in layout units
+ */
+void particleInit(particle_system_t* system, int capacity, const layout_cache_t* layoutCache, float margin);
+
+/**
+ * @description: add a particle. When the system is full it takes the place of the particle with the least life left.
+ * @param life: frames the particle lives, or PARTICLE_IMMORTAL
+ * @return: the index of the new particle
+ */
+int particleSpawn(particle_system_t* system, float x, float y, float vx, float vy, float R, float G, float B, float life);
+
+/**
+ * @description: move every particle by its velocity, bounce the ones that left the hull and remove the ones
+ * whose life ran out. Removing a particle moves the last one into its place.
+ */
+void particleStep(particle_system_t* system);
+
+/**
+ * @description: free the particle and hull arrays
+ */
+void particleFree(particle_system_t* system);
+
+#endif /* INC_PARTICLESYSTEM_H_ */
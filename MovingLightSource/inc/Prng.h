@@ -0,0 +1,69 @@
+/**
+    Prng.h
+
+    Description:
+    A small seedable random number generator, one per effect instance. drand48() keeps its state in a hidden
+    global, so two instances on different threads share (and race on) one sequence and a run can not be
+    replayed. Each instance owns a prng_t instead, seeded at create time, so the simulator can replay an
+    installation bit for bit and instances never contend.
+
+    The generator is xoshiro256** by Blackman and Vigna: 32 bytes of state, a handful of shifts, rotates and
+    multiplies per number and good statistical quality. The seed is expanded into the state with splitmix64,
+    so any seed, 0 included, gives a usable state.
+ */
+
+#ifndef INC_PRNG_H_
+#define INC_PRNG_H_
+
+#include <stdint.h>
+
+typedef struct {
+    uint64_t s[4];
+} prng_t;
+
+/**
+ * @description: seed the generator, the same seed always gives the same sequence
+ */
+void prngSeed(prng_t* prng, uint64_t seed);
+
+static inline uint64_t prngRotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * @description: the next 64 random bits
+ */
+static inline uint64_t prngNext(prng_t* prng)
+{
+    uint64_t* s = prng->s;
+    uint64_t result = prngRotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = prngRotl(s[3], 45);
+    return result;
+}
+
+/**
+ * @description: a random number in [0, 1) with 53 random bits
+ */
+static inline double prngUnit(prng_t* prng)
+{
+    return (prngNext(prng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @description: a random integer in [0, bound), each value equally likely. 0 for a bound of 0.
+ */
+uint32_t prngBounded(prng_t* prng, uint32_t bound);
+
+/**
+ * @description: fill values with n random integers in [0, bound), or with n random 32 bit words for a bound of 0
+ */
+void prngFill(prng_t* prng, uint32_t* values, int n, uint32_t bound);
+
+#endif /* INC_PRNG_H_ */
@@ -0,0 +1,70 @@
+/**
+    SplatRenderer.h
+
+    Description:
+    Renders light sources by scattering rather than gathering. Instead of every panel looking at every source,
+    each source finds its nearest panels through the layout cache's spatial grid and adds its colour, weighted
+    by the falloff, into their accumulators. A frame then costs sources x panels per source rather than
+    panels x sources, which is what makes hundreds or thousands of small sources affordable.
+
+    When the accumulators are read the colour is divided by the total weight once that is above 1, so a lone
+    source fades into the background exactly like the gather loop's blend did, while many sources landing on
+    one panel average out instead of saturating.
+
+    Only the panels splatted this frame or the frame before can have changed, the buffer keeps both lists so
+    the caller only has to look at those.
+ */
+
+#ifndef INC_SPLATRENDERER_H_
+#define INC_SPLATRENDERER_H_
+
+#include "LayoutCache.h"
+#include "ColorUtils.h"
+
+#define SPLAT_MAX_PANELS 32 // the most panels a single source can splat into
+
+typedef struct {
+    int nPanels;
+    int panelsPerSplat;             // a source lands on this many of its nearest panels
+    float radius;                   // and only on those within this distance, in layout units
+    float falloff;                  // a panel d adjacent distances away gets 1 / (d^2 * falloff + 1) of the colour
+    float adjacentDistance;
+    float* R;                       // the accumulators, colour times weight
+    float* G;
+    float* B;
+    float* weight;
+    int* touched;                   // the panels splatted since splatBegin()
+    int nTouched;
+    int* previous;                  // the panels splatted the frame before
+    int nPrevious;
+    bool* inFrame;                  // whether a panel is on touched
+} splat_buffer_t;
+
+/**
+ * @description: make the accumulators for a layout, every panel starts dark
+ * @param panelsPerSplat: up to SPLAT_MAX_PANELS
+ */
+void splatInit(splat_buffer_t* buffer, int nPanels, int panelsPerSplat, float radius, float falloff, float adjacentDistance);
+
+/**
+ * @description: start a frame. The panels splatted so far move to previous and their accumulators are cleared.
+ */
+void splatBegin(splat_buffer_t* buffer);
+
+/**
+ * @description: add a source at (x, y) to its nearest panels
+ * @param intensity: scales the weight, 1 for a source at full strength
+ */
+void splatSource(splat_buffer_t* buffer, const layout_cache_t* layoutCache, float x, float y, float R, float G, float B, float intensity);
+
+/**
+ * @description: the colour of a panel over a background, from what was splatted into it this frame
+ */
+void splatColour(const splat_buffer_t* buffer, int panel, const RGB_t* background, int* R, int* G, int* B);
+
+/**
+ * @description: free the accumulators
+ */
+void splatFree(splat_buffer_t* buffer);
+
+#endif /* INC_SPLATRENDERER_H_ */
@@ -20,9 +20,8 @@
 #include "LayoutProcessingUtils.h"
 #include "ColorUtils.h"
 #include "DataManager.h"
-#include <math.h>
 #include "PluginFeatures.h"
-#include "Logger.h"
+#include "MovingLightSource.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -36,30 +35,10 @@ extern "C" {
 }
 #endif
 
-#define TRANSITION_TIME 1
-#define MAX_SOURCES 7
-#define BASE_COLOR_R 0 // the next three are background colors
-#define BASE_COLOR_G 0
-#define BASE_COLOR_B 0
-#define ADJACENT_PANEL_DISTANCE 86.599995 // hard coded distance between panel centeroids
+#define DETECTOR_STATE_PATH "/var/lib/nanoleaf/plugins/MovingLightSource/detector.state" // the beat detector state is kept here between loads, in the plugin's own directory. NULL disables it
+#define RANDOM_SEED 48 // seeds where and in which direction beats launch their light sources, fixed so every load plays the same way
 
-
-typedef struct {
-  float x;
-  float y;
-  int R;
-  int G;
-  int B;
-} source_t;
-
-static RGB_t* palettenColors = NULL;
-static int nColors = 0;
-static LayoutData *layoutData;
-static source_t *sources;
-static int nSources = 0;
-static bool toggle = false;
-static bool toggle1 = false;
-static int movementSpeed = 5;
+static moving_light_source_t* instance = NULL; // the effect this plugin shows
 
 /**
  * @description: Initialize the plugin. Called once, when the plugin is loaded.
@@ -70,59 +49,14 @@ static int movementSpeed = 5;
  *
  */
 void initPlugin(){
-	getColorPalette(&palettenColors, &nColors);
-	layoutData = getLayoutData();
-
-  PRINTLOG("The layout has %d panels:\n", layoutData->nPanels);
-  for (int i = 0; i < layoutData->nPanels; i++) {
-      PRINTLOG("   Id: %d   X, Y: %lf, %lf\n", layoutData->panels[i].panelId,
-             layoutData->panels[i].shape->getCentroid().x, layoutData->panels[i].shape->getCentroid().y);
-  }
-
-  sources = new source_t[1];
-  sources[0].x = -299;
-  sources[0].y = 0;
-  sources[0].R = 0;
-  sources[0].G = 255;
-  sources[0].B = 255;
-  nSources++;
-}
-
-/** Compute cartesian distance between two points */
-float distance(float x1, float y1, float x2, float y2)
-{
-    float dx = x2 - x1;
-    float dy = y2 - y1;
-    return sqrt(dx * dx + dy * dy);
+  RGB_t* paletteColours = NULL;
+  int nColours = 0;
+  getColorPalette(&paletteColours, &nColours);  // grab the palette colours
+  instance = movingLightSourceCreate(getLayoutData(), paletteColours, nColours, RANDOM_SEED);
+  movingLightSourceRestoreDetector(instance, DETECTOR_STATE_PATH);
+  enableFft(movingLightSourceFftBins(instance));
 }
 
-/**
-  * @description: This function will render the colour of the given single panel given
-  * the positions of all the lights in the light source list.
-  */
-void renderPanel(Panel *panel, int *returnR, int *returnG, int *returnB) {
-  float R = BASE_COLOR_R;
-  float G = BASE_COLOR_G;
-  float B = BASE_COLOR_B;
-
-  //Iterate through all the sources
-  //Depending how close the source is to the panel, we take some fraction of its color and mix it into an
-  //accumulator. Newest soruces have the most weight. Old sources die away until they are gone.
-  for(int i = 0; i < nSources; i++) {
-    float d = distance(panel->shape->getCentroid().x, panel->shape->getCentroid().y,
-                       sources[i].x, sources[i].y);
-    d = d / ADJACENT_PANEL_DISTANCE;
-    float d2 = d*d;
-    float factor = 1.0 / (d2*1.5 + 1.0);
-
-    R = R * (1.0 - factor) + sources[i].R * factor;
-    G = G * (1.0 - factor) + sources[i].G * factor;
-    B = B * (1.0 - factor) + sources[i].B * factor;
-  }
-  *returnR = (int)R;
-  *returnG = (int)G;
-  *returnB = (int)B;
-}
 /**
 RGB_t calculateColor(RGB_t color, Frame_t panel) {
 	HSV_t value;
@@ -149,40 +83,7 @@ RGB_t calculateColor(RGB_t color, Frame_t panel) {
  * @param sleepTime: specify interval after which this function is called again, NULL if sound visualization plugin
  */
 void getPluginFrame(Frame_t* frames, int* nFrames, int* sleepTime){
-  int R;
-  int G;
-  int B;
-	for(int i =0; i < layoutData->nPanels; i++) {
-		//RGB_t color = calculateColor(frameColors[i], frames[i]);
-    renderPanel(&layoutData->panels[i], &R, &G, &B);
-		frames[i].panelId = layoutData->panels[i].panelId;
-		frames[i].r = R;
-		frames[i].g = G;
-		frames[i].b = B;
-		frames[i].transTime = TRANSITION_TIME;
-	}
-  if(toggle && toggle1) {
-    sources[0].x += movementSpeed;
-  } else if(!toggle && !toggle1){
-    sources[0].x -= movementSpeed;
-  } else if(!toggle && toggle1) {
-    sources[0].y += movementSpeed;
-  } else if(toggle && !toggle1){
-    sources[0].y -= movementSpeed;
-  }
-
-  if(sources[0].x >= -299 + ADJACENT_PANEL_DISTANCE * 2) {
-    toggle = false;
-  } else if(sources[0].x <= -299) {
-    toggle = true;
-  }
-  if(sources[0].y >= -86 + ADJACENT_PANEL_DISTANCE) {
-    toggle1 = false;
-  } else if(sources[0].y <= -86) {
-    toggle1 = true;
-  }
-  //PRINTLOG("X: %f Y: %f\n", sources[0].x, sources[0].y);
-	*nFrames = layoutData->nPanels;
+  movingLightSourceFrame(instance, getFftBins(), frames, nFrames);
 }
 
 /**
@@ -191,4 +92,7 @@ void getPluginFrame(Frame_t* frames, int* nFrames, int* sleepTime){
  */
 void pluginCleanup(){
 	//do deallocation here
+  movingLightSourceSaveDetector(instance, DETECTOR_STATE_PATH);
+  movingLightSourceDestroy(instance);
+  instance = NULL;
 }
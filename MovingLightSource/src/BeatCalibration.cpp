@@ -0,0 +1,81 @@
+/**
+    BeatCalibration.cpp
+
+    Description:
+    Warm-up calibration for the beat detector, see BeatCalibration.h.
+    A percentile is read back as the middle of the bucket it falls in, so it is off by at most half a bucket.
+ */
+
+#include "BeatCalibration.h"
+#include <string.h>
+
+static uint8_t histogramPercentile(const level_histogram_t* histogram, int frames, int percent)
+{
+    // rank of the frame we are after, 1 based
+    int rank = (frames * percent + 50) / 100;
+    if(rank < 1) {
+        rank = 1;
+    }
+    int seen = 0;
+    for(int i = 0; i < CALIBRATION_BUCKETS; i++) {
+        seen += histogram->counts[i];
+        if(seen >= rank) {
+            return (i << CALIBRATION_BUCKET_SHIFT) + (1 << CALIBRATION_BUCKET_SHIFT) / 2;
+        }
+    }
+    return 255;
+}
+
+void calibrationInit(beat_calibration_t* calibration, int nBins)
+{
+    calibration->nBins = nBins > 0 ? nBins : 0;
+    calibration->bins = new level_histogram_t[calibration->nBins]();
+    calibration->last = new uint8_t[calibration->nBins]();
+    calibration->secondLast = new uint8_t[calibration->nBins]();
+    calibration->frames = 0;
+}
+
+bool calibrationAdd(beat_calibration_t* calibration, const uint8_t* fftBins)
+{
+    if(calibrationDone(calibration)) {
+        return true;
+    }
+    for(int i = 0; i < calibration->nBins; i++) {
+        calibration->bins[i].counts[fftBins[i] >> CALIBRATION_BUCKET_SHIFT]++;
+        calibration->secondLast[i] = calibration->last[i];
+        calibration->last[i] = fftBins[i];
+    }
+    calibration->frames++;
+    return calibrationDone(calibration);
+}
+
+bool calibrationDone(const beat_calibration_t* calibration)
+{
+    return calibration->frames >= CALIBRATION_FRAMES;
+}
+
+void calibrationSkip(beat_calibration_t* calibration)
+{
+    calibration->frames = CALIBRATION_FRAMES;
+}
+
+uint8_t calibrationNoiseFloor(const beat_calibration_t* calibration, int bin)
+{
+    return histogramPercentile(&calibration->bins[bin], calibration->frames, CALIBRATION_FLOOR_PERCENTILE);
+}
+
+uint8_t calibrationPeak(const beat_calibration_t* calibration, int bin)
+{
+    return histogramPercentile(&calibration->bins[bin], calibration->frames, CALIBRATION_PEAK_PERCENTILE);
+}
+
+void calibrationFree(beat_calibration_t* calibration)
+{
+    delete [] calibration->bins;
+    delete [] calibration->last;
+    delete [] calibration->secondLast;
+    calibration->bins = NULL;
+    calibration->last = NULL;
+    calibration->secondLast = NULL;
+    calibration->nBins = 0;
+}
@@ -0,0 +1,99 @@
+/**
+    DetectorState.cpp
+
+    Description:
+    Saves and restores the beat detector state across plugin reloads, see DetectorState.h.
+ */
+
+#include "DetectorState.h"
+#include "Logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define DETECTOR_STATE_DIR_MODE 0700 // directories made for the state file are private to the plugin's user
+
+/** Make the directories leading up to path that do not exist yet */
+static bool makeParentDirectories(const char* path)
+{
+    char directory[512];
+    snprintf(directory, sizeof(directory), "%s", path);
+    for(char* slash = strchr(directory + 1, '/'); slash != NULL; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        if(mkdir(directory, DETECTOR_STATE_DIR_MODE) != 0 && errno != EEXIST) {
+            return false;
+        }
+        *slash = '/';
+    }
+    return true;
+}
+
+bool detectorStateSave(const char* path, const detector_bin_state_t* bins, int nBins, float tempo)
+{
+    detector_state_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = DETECTOR_STATE_MAGIC;
+    header.version = DETECTOR_STATE_VERSION;
+    header.savedAt = time(NULL);
+    header.nBins = nBins;
+    header.tempo = tempo;
+
+    // mkstemp() makes a new file of its own, it never follows a link planted at the name and two instances
+    // saving at once each get their own
+    char tempPath[512];
+    snprintf(tempPath, sizeof(tempPath), "%s.XXXXXX", path);
+    int fd = makeParentDirectories(path) ? mkstemp(tempPath) : -1;
+    FILE* file = fd < 0 ? NULL : fdopen(fd, "wb");
+    if(file == NULL) {
+        PRINTLOG("Could not write the detector state to %s\n", path);
+        if(fd >= 0) {
+            close(fd);
+            unlink(tempPath);
+        }
+        return false;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    written = (nBins == 0 || fwrite(bins, sizeof(detector_bin_state_t), nBins, file) == (size_t)nBins) && written;
+    written = fclose(file) == 0 && written;
+    if(!written || rename(tempPath, path) != 0) {
+        PRINTLOG("Could not write the detector state to %s\n", path);
+        unlink(tempPath);
+        return false;
+    }
+    return true;
+}
+
+bool detectorStateLoad(const char* path, detector_bin_state_t* bins, int nBins, float* tempo)
+{
+    FILE* file = fopen(path, "rb");
+    if(file == NULL) {
+        return false;
+    }
+    detector_state_header_t header;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1 &&
+                 header.magic == DETECTOR_STATE_MAGIC && header.version == DETECTOR_STATE_VERSION &&
+                 header.nBins == nBins;
+    int64_t age = valid ? (int64_t)time(NULL) - header.savedAt : -1;
+    if(valid && (age < 0 || age > DETECTOR_STATE_MAX_AGE)) {
+        PRINTLOG("Detector state in %s is %lld seconds old, calibrating instead\n", path, (long long)age);
+        valid = false;
+    }
+
+    // read into a scratch copy so a truncated file leaves the caller's bins alone
+    detector_bin_state_t* loaded = valid ? new detector_bin_state_t[nBins > 0 ? nBins : 1] : NULL;
+    if(valid) {
+        valid = (nBins == 0 || fread(loaded, sizeof(detector_bin_state_t), nBins, file) == (size_t)nBins) &&
+                fgetc(file) == EOF;
+    }
+    fclose(file);
+    if(valid) {
+        memcpy(bins, loaded, nBins * sizeof(detector_bin_state_t));
+        *tempo = header.tempo;
+    }
+    delete [] loaded;
+    return valid;
+}
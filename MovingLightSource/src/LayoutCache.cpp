@@ -0,0 +1,480 @@
+/**
+    LayoutCache.cpp
+
+    Description:
+    Builds the layout derived data into a single arena, see LayoutCache.h.
+    The spatial grid is built first (a counting sort of the panels into square cells one adjacent panel
+    distance wide) and is then used to find the neighbours and influence lists of every panel without
+    comparing every pair of panels. The hop distance table, when asked for, is then filled in from the adjacency lists.
+ */
+
+#include "LayoutCache.h"
+#include "Logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include <new>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define ARENA_ALIGNMENT 16 // every array in the arena starts on this boundary
+#define ADJACENCY_TOLERANCE 1.1 // panels up to this many adjacent distances apart count as neighbours
+#define PARALLEL_HOPS_MIN_PANELS 256 // below this many panels the hop distances are searched on the calling thread
+
+/** FNV-1a, used to key the cache file on the layout */
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    for(size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+static uint64_t hashLayout(LayoutData* layoutData, float adjacentDistance, float influenceRadius, bool hopDistances)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    uint32_t version = LAYOUT_CACHE_VERSION;
+    uint8_t withHops = hopDistances;
+    hash = hashBytes(hash, &version, sizeof(version));
+    hash = hashBytes(hash, &adjacentDistance, sizeof(adjacentDistance));
+    hash = hashBytes(hash, &influenceRadius, sizeof(influenceRadius));
+    hash = hashBytes(hash, &withHops, sizeof(withHops));
+    hash = hashBytes(hash, &layoutData->nPanels, sizeof(layoutData->nPanels));
+    for(int i = 0; i < layoutData->nPanels; i++) {
+        const Point& centroid = layoutData->panels[i].shape->getCentroid();
+        int orientation = layoutData->panels[i].shape->getOrientation();
+        hash = hashBytes(hash, &layoutData->panels[i].panelId, sizeof(int));
+        hash = hashBytes(hash, &centroid.x, sizeof(double));
+        hash = hashBytes(hash, &centroid.y, sizeof(double));
+        hash = hashBytes(hash, &orientation, sizeof(int));
+    }
+    return hash;
+}
+
+static uint32_t alignUp(uint32_t offset)
+{
+    return (offset + ARENA_ALIGNMENT - 1) & ~(uint32_t)(ARENA_ALIGNMENT - 1);
+}
+
+/** Allocate the arena, running out of memory throws std::bad_alloc like new does */
+static layout_cache_header_t* allocateArena(uint32_t size)
+{
+    void* arena = NULL;
+    if(posix_memalign(&arena, ARENA_ALIGNMENT, size) != 0) {
+        throw std::bad_alloc();
+    }
+    return (layout_cache_header_t*)arena;
+}
+
+/** Point the convenience pointers of the cache at the arrays inside its arena */
+static void bindArena(layout_cache_t* cache, const layout_cache_header_t* header)
+{
+    const char* base = (const char*)header;
+    cache->header = header;
+    cache->view.nPanels = header->nPanels;
+    cache->view.panelIds = (const int32_t*)(base + header->panelIdsOffset);
+    cache->view.x = (const float*)(base + header->xOffset);
+    cache->view.y = (const float*)(base + header->yOffset);
+    cache->view.orientation = (const int32_t*)(base + header->orientationOffset);
+    cache->view.shapeType = (const int32_t*)(base + header->shapeTypeOffset);
+    cache->adjacencyStart = (const int*)(base + header->adjacencyStartOffset);
+    cache->adjacency = (const int*)(base + header->adjacencyOffset);
+    cache->influenceStart = (const int*)(base + header->influenceStartOffset);
+    cache->influence = (const influence_t*)(base + header->influenceOffset);
+    cache->gridStart = (const int*)(base + header->gridStartOffset);
+    cache->gridPanels = (const int*)(base + header->gridPanelsOffset);
+    cache->hops = header->hopsSize > 0 ? (const uint8_t*)(base + header->hopsOffset) : NULL;
+}
+
+/** The size of the hop distance table of a layout, every tile on or below the diagonal */
+static uint32_t hopTableSize(int nPanels)
+{
+    uint32_t tileRows = (nPanels + LAYOUT_CACHE_HOP_TILE - 1) / LAYOUT_CACHE_HOP_TILE;
+    return tileRows * (tileRows + 1) / 2 * LAYOUT_CACHE_HOP_TILE * LAYOUT_CACHE_HOP_TILE;
+}
+
+/** Whether count elements of elementSize starting at offset end within an arena of size bytes */
+static bool arrayFits(uint32_t offset, uint64_t count, size_t elementSize, uint32_t size)
+{
+    return offset + count * elementSize <= size;
+}
+
+/**
+  * Check that a header read from disk belongs to this layout and that all its arrays lie inside the file.
+  * The ends of the adjacency and influence lists are read from their start arrays, which are checked first.
+  */
+static bool validHeader(const layout_cache_header_t* header, uint64_t layoutHash, int nPanels, size_t fileSize)
+{
+    if(header->magic != LAYOUT_CACHE_MAGIC || header->version != LAYOUT_CACHE_VERSION ||
+       header->layoutHash != layoutHash || header->size != fileSize || header->nPanels != nPanels ||
+       header->gridWidth <= 0 || header->gridHeight <= 0) {
+        return false;
+    }
+    uint32_t offsets[] = {header->panelIdsOffset, header->xOffset, header->yOffset, header->orientationOffset,
+                          header->shapeTypeOffset, header->adjacencyStartOffset, header->adjacencyOffset, header->influenceStartOffset,
+                          header->influenceOffset, header->gridStartOffset, header->gridPanelsOffset, header->hopsOffset};
+    for(size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) {
+        if(offsets[i] < sizeof(layout_cache_header_t) || offsets[i] > header->size || offsets[i] % ARENA_ALIGNMENT != 0) {
+            return false;
+        }
+    }
+    uint32_t size = header->size;
+    uint64_t nCells = (uint64_t)header->gridWidth * header->gridHeight;
+    if(!arrayFits(header->panelIdsOffset, nPanels, sizeof(int32_t), size) ||
+       !arrayFits(header->xOffset, nPanels, sizeof(float), size) ||
+       !arrayFits(header->yOffset, nPanels, sizeof(float), size) ||
+       !arrayFits(header->orientationOffset, nPanels, sizeof(int32_t), size) ||
+       !arrayFits(header->shapeTypeOffset, nPanels, sizeof(int32_t), size) ||
+       !arrayFits(header->adjacencyStartOffset, nPanels + 1, sizeof(int), size) ||
+       !arrayFits(header->influenceStartOffset, nPanels + 1, sizeof(int), size) ||
+       !arrayFits(header->gridStartOffset, nCells + 1, sizeof(int), size) ||
+       !arrayFits(header->gridPanelsOffset, nPanels, sizeof(int), size) ||
+       (header->hopsSize != 0 && header->hopsSize != hopTableSize(nPanels)) ||
+       !arrayFits(header->hopsOffset, header->hopsSize, 1, size)) {
+        return false;
+    }
+    const char* base = (const char*)header;
+    int nAdjacency = ((const int*)(base + header->adjacencyStartOffset))[nPanels];
+    int nInfluence = ((const int*)(base + header->influenceStartOffset))[nPanels];
+    return nAdjacency >= 0 && arrayFits(header->adjacencyOffset, nAdjacency, sizeof(int), size) &&
+           nInfluence >= 0 && arrayFits(header->influenceOffset, nInfluence, sizeof(influence_t), size);
+}
+
+/** Map an arena that was saved for the same layout read-only, returns NULL if there is none */
+static const layout_cache_header_t* mapArena(const char* cachePath, uint64_t layoutHash, int nPanels)
+{
+    int fd = open(cachePath, O_RDONLY);
+    if(fd < 0) {
+        return NULL;
+    }
+    struct stat info;
+    void* mapping = MAP_FAILED;
+    if(fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(layout_cache_header_t)) {
+        mapping = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd); // the mapping stays valid after the descriptor is closed
+    if(mapping == MAP_FAILED) {
+        return NULL;
+    }
+    const layout_cache_header_t* header = (const layout_cache_header_t*)mapping;
+    if(!validHeader(header, layoutHash, nPanels, info.st_size)) {
+        munmap(mapping, info.st_size);
+        return NULL;
+    }
+    return header;
+}
+
+/**
+  * Write the arena to a uniquely named temporary file next to cachePath and rename it into place. rename() is
+  * atomic, so another plugin instance mapping the cache sees either the old file or a complete new one, and
+  * instances saving the same cache at once each write their own file.
+  */
+static void saveArena(const char* cachePath, const layout_cache_header_t* arena)
+{
+    char tempPath[512];
+    snprintf(tempPath, sizeof(tempPath), "%s.XXXXXX", cachePath);
+    int fd = mkstemp(tempPath);
+    FILE* file = fd < 0 ? NULL : fdopen(fd, "wb");
+    if(file == NULL) {
+        PRINTLOG("Could not write the layout cache to %s\n", cachePath);
+        if(fd >= 0) {
+            close(fd);
+            unlink(tempPath);
+        }
+        return;
+    }
+    bool written = fwrite(arena, 1, arena->size, file) == arena->size;
+    written = fflush(file) == 0 && written;
+    written = fsync(fileno(file)) == 0 && written;
+    fclose(file);
+    if(!written || rename(tempPath, cachePath) != 0) {
+        PRINTLOG("Could not write the layout cache to %s\n", cachePath);
+        unlink(tempPath);
+    }
+}
+
+/** Gather every panel within radius of panel p from the spatial grid, sorted by panel index */
+static void collectNearby(const float* xs, const float* ys, const std::vector<int>& gridStart, const std::vector<int>& gridPanels,
+                          int gridWidth, int gridHeight, float originX, float originY, float cellSize,
+                          int p, float radius, std::vector<int>* found)
+{
+    found->clear();
+    int reach = (int)ceil(radius / cellSize);
+    int cx = (int)((xs[p] - originX) / cellSize);
+    int cy = (int)((ys[p] - originY) / cellSize);
+    float radius2 = radius * radius;
+    for(int y = std::max(0, cy - reach); y <= std::min(gridHeight - 1, cy + reach); y++) {
+        for(int x = std::max(0, cx - reach); x <= std::min(gridWidth - 1, cx + reach); x++) {
+            int cell = y * gridWidth + x;
+            for(int i = gridStart[cell]; i < gridStart[cell + 1]; i++) {
+                int q = gridPanels[i];
+                float dx = xs[q] - xs[p];
+                float dy = ys[q] - ys[p];
+                if(dx * dx + dy * dy <= radius2) {
+                    found->push_back(q);
+                }
+            }
+        }
+    }
+    std::sort(found->begin(), found->end());
+}
+
+/**
+  * Breadth first search from the panels first, first + step, ... filling in their rows of the hop distance table.
+  * The search from panel s only writes the distances to the panels up to s, which is the part of the lower
+  * triangle no other search touches, so searches can run on several threads at once.
+  */
+static void searchHops(const int* adjacencyStart, const int* adjacency, int nPanels, int first, int step, uint8_t* hops)
+{
+    std::vector<int> queue(nPanels);
+    std::vector<int> distance(nPanels, -1);
+    for(int s = first; s < nPanels; s += step) {
+        int head = 0;
+        int tail = 0;
+        queue[tail++] = s;
+        distance[s] = 0;
+        while(head < tail) {
+            int p = queue[head++];
+            if(p <= s) {
+                hops[layoutCacheHopIndex(s, p)] = std::min(distance[p], LAYOUT_CACHE_HOPS_MAX);
+            }
+            for(int i = adjacencyStart[p]; i < adjacencyStart[p + 1]; i++) {
+                int q = adjacency[i];
+                if(distance[q] < 0) {
+                    distance[q] = distance[p] + 1;
+                    queue[tail++] = q;
+                }
+            }
+        }
+        // the queue holds exactly the panels that were reached
+        for(int i = 0; i < tail; i++) {
+            distance[queue[i]] = -1;
+        }
+    }
+}
+
+/** Fill in the hop distance table, on every core for large layouts */
+static void buildHops(const std::vector<int>& adjacencyStart, const std::vector<int>& adjacency, int nPanels, uint8_t* hops)
+{
+    memset(hops, LAYOUT_CACHE_HOPS_UNREACHABLE, hopTableSize(nPanels));
+    int nThreads = 1;
+    if(nPanels >= PARALLEL_HOPS_MIN_PANELS) {
+        nThreads = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    // the searches are dealt out in turn, which balances the longer rows at the end of the triangle
+    std::vector<std::thread> threads;
+    for(int t = 1; t < nThreads; t++) {
+        threads.push_back(std::thread(searchHops, adjacencyStart.data(), adjacency.data(), nPanels, t, nThreads, hops));
+    }
+    searchHops(adjacencyStart.data(), adjacency.data(), nPanels, 0, nThreads, hops);
+    for(size_t t = 0; t < threads.size(); t++) {
+        threads[t].join();
+    }
+}
+
+static layout_cache_header_t* buildArena(LayoutData* layoutData, float adjacentDistance, float influenceRadius, bool hopDistances,
+                                         uint64_t layoutHash)
+{
+    int nPanels = layoutData->nPanels;
+    std::vector<int32_t> panelIds(nPanels);
+    std::vector<float> xs(nPanels);
+    std::vector<float> ys(nPanels);
+    std::vector<int32_t> orientations(nPanels);
+    std::vector<int32_t> shapeTypes(nPanels);
+    float minX = 0;
+    float minY = 0;
+    float maxX = 0;
+    float maxY = 0;
+    for(int i = 0; i < nPanels; i++) {
+        Shape* shape = layoutData->panels[i].shape;
+        panelIds[i] = layoutData->panels[i].panelId;
+        xs[i] = shape->getCentroid().x;
+        ys[i] = shape->getCentroid().y;
+        orientations[i] = shape->getOrientation();
+        shapeTypes[i] = shape->shapeType;
+        if(i == 0 || xs[i] < minX) minX = xs[i];
+        if(i == 0 || ys[i] < minY) minY = ys[i];
+        if(i == 0 || xs[i] > maxX) maxX = xs[i];
+        if(i == 0 || ys[i] > maxY) maxY = ys[i];
+    }
+
+    // spatial grid, counting sort of the panels into the cells
+    float cellSize = adjacentDistance;
+    int gridWidth = (int)((maxX - minX) / cellSize) + 1;
+    int gridHeight = (int)((maxY - minY) / cellSize) + 1;
+    int nCells = gridWidth * gridHeight;
+    std::vector<int> gridStart(nCells + 1, 0);
+    std::vector<int> gridPanels(nPanels);
+    std::vector<int> panelCell(nPanels);
+    for(int i = 0; i < nPanels; i++) {
+        panelCell[i] = (int)((ys[i] - minY) / cellSize) * gridWidth + (int)((xs[i] - minX) / cellSize);
+        gridStart[panelCell[i] + 1]++;
+    }
+    for(int c = 0; c < nCells; c++) {
+        gridStart[c + 1] += gridStart[c];
+    }
+    std::vector<int> fill(gridStart.begin(), gridStart.end() - 1);
+    for(int i = 0; i < nPanels; i++) {
+        gridPanels[fill[panelCell[i]]++] = i;
+    }
+
+    // adjacency and influence lists, gathered from the grid
+    std::vector<int> adjacencyStart(nPanels + 1);
+    std::vector<int> adjacency;
+    std::vector<int> influenceStart(nPanels + 1);
+    std::vector<influence_t> influence;
+    std::vector<int> found;
+    for(int p = 0; p < nPanels; p++) {
+        adjacencyStart[p] = adjacency.size();
+        collectNearby(xs.data(), ys.data(), gridStart, gridPanels, gridWidth, gridHeight, minX, minY, cellSize,
+                      p, adjacentDistance * ADJACENCY_TOLERANCE, &found);
+        for(size_t i = 0; i < found.size(); i++) {
+            if(found[i] != p) {
+                adjacency.push_back(found[i]);
+            }
+        }
+
+        influenceStart[p] = influence.size();
+        collectNearby(xs.data(), ys.data(), gridStart, gridPanels, gridWidth, gridHeight, minX, minY, cellSize,
+                      p, adjacentDistance * influenceRadius, &found);
+        for(size_t i = 0; i < found.size(); i++) {
+            influence_t entry;
+            float dx = (xs[found[i]] - xs[p]) / adjacentDistance;
+            float dy = (ys[found[i]] - ys[p]) / adjacentDistance;
+            entry.panel = found[i];
+            entry.d2 = dx * dx + dy * dy;
+            influence.push_back(entry);
+        }
+    }
+    adjacencyStart[nPanels] = adjacency.size();
+    influenceStart[nPanels] = influence.size();
+
+    // lay the arrays out one after the other in the arena
+    layout_cache_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = LAYOUT_CACHE_MAGIC;
+    header.version = LAYOUT_CACHE_VERSION;
+    header.layoutHash = layoutHash;
+    header.nPanels = nPanels;
+    header.gridWidth = gridWidth;
+    header.gridHeight = gridHeight;
+    header.gridOriginX = minX;
+    header.gridOriginY = minY;
+    header.gridCellSize = cellSize;
+    uint32_t offset = alignUp(sizeof(header));
+    header.panelIdsOffset = offset;
+    offset = alignUp(offset + nPanels * sizeof(int32_t));
+    header.xOffset = offset;
+    offset = alignUp(offset + nPanels * sizeof(float));
+    header.yOffset = offset;
+    offset = alignUp(offset + nPanels * sizeof(float));
+    header.orientationOffset = offset;
+    offset = alignUp(offset + nPanels * sizeof(int32_t));
+    header.shapeTypeOffset = offset;
+    offset = alignUp(offset + nPanels * sizeof(int32_t));
+    header.adjacencyStartOffset = offset;
+    offset = alignUp(offset + adjacencyStart.size() * sizeof(int));
+    header.adjacencyOffset = offset;
+    offset = alignUp(offset + adjacency.size() * sizeof(int));
+    header.influenceStartOffset = offset;
+    offset = alignUp(offset + influenceStart.size() * sizeof(int));
+    header.influenceOffset = offset;
+    offset = alignUp(offset + influence.size() * sizeof(influence_t));
+    header.gridStartOffset = offset;
+    offset = alignUp(offset + gridStart.size() * sizeof(int));
+    header.gridPanelsOffset = offset;
+    offset = alignUp(offset + gridPanels.size() * sizeof(int));
+    header.hopsOffset = offset;
+    header.hopsSize = hopDistances ? hopTableSize(nPanels) : 0;
+    offset = alignUp(offset + header.hopsSize);
+    header.size = offset;
+
+    layout_cache_header_t* arena = allocateArena(header.size);
+    char* base = (char*)arena;
+    memset(base, 0, header.size);
+    memcpy(base, &header, sizeof(header));
+    memcpy(base + header.panelIdsOffset, panelIds.data(), nPanels * sizeof(int32_t));
+    memcpy(base + header.xOffset, xs.data(), nPanels * sizeof(float));
+    memcpy(base + header.yOffset, ys.data(), nPanels * sizeof(float));
+    memcpy(base + header.orientationOffset, orientations.data(), nPanels * sizeof(int32_t));
+    memcpy(base + header.shapeTypeOffset, shapeTypes.data(), nPanels * sizeof(int32_t));
+    memcpy(base + header.adjacencyStartOffset, adjacencyStart.data(), adjacencyStart.size() * sizeof(int));
+    memcpy(base + header.adjacencyOffset, adjacency.data(), adjacency.size() * sizeof(int));
+    memcpy(base + header.influenceStartOffset, influenceStart.data(), influenceStart.size() * sizeof(int));
+    memcpy(base + header.influenceOffset, influence.data(), influence.size() * sizeof(influence_t));
+    memcpy(base + header.gridStartOffset, gridStart.data(), gridStart.size() * sizeof(int));
+    memcpy(base + header.gridPanelsOffset, gridPanels.data(), gridPanels.size() * sizeof(int));
+    if(hopDistances) {
+        buildHops(adjacencyStart, adjacency, nPanels, (uint8_t*)(base + header.hopsOffset));
+    }
+    return arena;
+}
+
+layout_cache_t* layoutCacheCreate(LayoutData* layoutData, float adjacentDistance, float influenceRadius, bool hopDistances,
+                                  const char* cachePath)
+{
+    uint64_t layoutHash = hashLayout(layoutData, adjacentDistance, influenceRadius, hopDistances);
+    layout_cache_t* cache = new layout_cache_t;
+    if(cachePath != NULL) {
+        const layout_cache_header_t* mapped = mapArena(cachePath, layoutHash, layoutData->nPanels);
+        if(mapped != NULL) {
+            PRINTLOG("Layout cache mapped from %s\n", cachePath);
+            bindArena(cache, mapped);
+            cache->mapped = true;
+            return cache;
+        }
+    }
+
+    layout_cache_header_t* arena = buildArena(layoutData, adjacentDistance, influenceRadius, hopDistances, layoutHash);
+    if(cachePath != NULL) {
+        saveArena(cachePath, arena);
+    }
+    bindArena(cache, arena);
+    cache->mapped = false;
+    return cache;
+}
+
+void layoutCacheDestroy(layout_cache_t* cache)
+{
+    if(cache == NULL) {
+        return;
+    }
+    if(cache->mapped) {
+        munmap((void*)cache->header, cache->header->size);
+    } else {
+        free((void*)cache->header);
+    }
+    delete cache;
+}
+
+int layoutCacheGridCell(const layout_cache_t* cache, float x, float y)
+{
+    const layout_cache_header_t* header = cache->header;
+    int cx = (int)floor((x - header->gridOriginX) / header->gridCellSize);
+    int cy = (int)floor((y - header->gridOriginY) / header->gridCellSize);
+    if(cx < 0 || cy < 0 || cx >= header->gridWidth || cy >= header->gridHeight) {
+        return -1;
+    }
+    return cy * header->gridWidth + cx;
+}
+
+void layoutCacheHopsFrom(const layout_cache_t* cache, int p, uint8_t* hops)
+{
+    // up to p the distances are row p of the tiles left of the diagonal, a tile width at a time
+    for(int first = 0; first <= p; first += LAYOUT_CACHE_HOP_TILE) {
+        int count = std::min(LAYOUT_CACHE_HOP_TILE, p + 1 - first);
+        memcpy(hops + first, cache->hops + layoutCacheHopIndex(p, first), count);
+    }
+    // past p they are column p of the tiles below
+    for(int q = p + 1; q < cache->view.nPanels; q++) {
+        hops[q] = cache->hops[layoutCacheHopIndex(q, p)];
+    }
+}
@@ -0,0 +1,356 @@
+/**
+    MovingLightSource.cpp
+
+    Description:
+    Beat Detection, FFT to light source color and Panel Color calculations based on FrequncyStars by Nathan Dyck.
+    A light source wanders over the panels, bouncing off the edge of the layout, and every detected beat launches
+    another one from the center of a random panel in the color of the frequency band. Those fly off in a random
+    direction, bounce around as well and fade out after a while. The sources are particles, see ParticleSystem.h,
+    and are splatted into their nearest panels rather than every panel looking at every source, see SplatRenderer.h.
+    All state lives in a moving_light_source_t so any number of instances can run side by side,
+    see MovingLightSource.h.
+ */
+
+#include "MovingLightSource.h"
+#include <math.h>
+#include "ColorUtils.h"
+#include "Logger.h"
+#include "LayoutCache.h"
+#include "SplatRenderer.h"
+#include "ParticleSystem.h"
+#include "BeatCalibration.h"
+#include "DetectorState.h"
+#include "BandMapper.h"
+#include "Prng.h"
+#include <algorithm>
+
+#define TRANSITION_TIME 1
+#define LOG_LAYOUT false // print every panel position on start-up
+#define MAX_PALETTE_COLOURS 7 // if more colours then this, we will use just the first this many
+#define BASE_COLOR_R 0 // the next three are background colors
+#define BASE_COLOR_G 0
+#define BASE_COLOR_B 0
+#define ADJACENT_PANEL_DISTANCE 86.599995 // hard coded distance between panel centeroids
+#define INFLUENCE_ERROR_BOUND 0.01 // panels where the source mixes in less than this fraction of its color are not re-rendered
+#define FALLOFF 1.5 // a panel d adjacent distances from the source mixes in 1 / (d^2 * FALLOFF + 1) of its color
+#define SPLAT_PANELS 16 // a source lights at most this many of its nearest panels
+#define MOVEMENT_SPEED 5 // layout units per frame of the wandering source
+#define MINIMUM_INTENSITY 0.2 // the minimum intensity of a source
+#define TRIGGER_THRESHOLD 0.7 // used to calculate whether to add a source
+#define MAX_PARTICLES 1024 // sources alive at once, a new one replaces the one closest to fading out
+#define PARTICLE_SPEED 12 // layout units per frame of a beat's source at full intensity
+#define PARTICLE_LIFE 60 // frames a beat's source lives
+#define PARTICLE_FADE 20 // a source dims over its last this many frames
+#define HULL_MARGIN 0.5 // sources bounce this many adjacent panel distances past the outermost centroids
+
+/** Here we store the information accociated with each frequency bin. This
+ allows for tracking a degree of historical information.
+ */
+typedef struct {
+  uint32_t latest_minimum;
+  uint32_t soundPower;
+  int16_t colour;
+  uint32_t runningMax;
+  uint32_t runningMin;
+  uint32_t maximumTrigger;
+  uint32_t previousPower;
+  uint32_t secondPreviousPower;
+} freq_bin;
+
+struct moving_light_source_t {
+  RGB_t *palette; // the colour palette, owned by the caller
+  int nColours; // the number of colours of the palette in use
+  layout_cache_t *layoutCache; // flat view of the panels used every frame
+  particle_system_t particles; // the light sources
+  splat_buffer_t splat; // the sources' colors accumulated on the panels they land on
+  bool firstFrame;
+  RGB_t *panelShown; // the color last sent to each panel
+  prng_t prng; // this instance's random numbers
+  freq_bin freq_bins[MAX_PALETTE_COLOURS]; // this is our array for frequency bin historical information.
+  beat_calibration_t calibration; // levels of the first frames, the frequency bins are seeded from them
+  band_mapper_t bandMapper; // maps the fft onto one band per palette colour
+};
+
+/**
+  * @description: add a value to a running max.
+  * @param: runningMax is current runningMax, valueToAdd is added to runningMax, effectiveTrail
+  *         defines how many values are effectively tracked. Note this is an approximation.
+  * @return: int returned as new runningMax.
+  */
+static int addToRunningMax(int runningMax, int valueToAdd, int effectiveTrail) {
+  int trail = effectiveTrail;
+  if (valueToAdd > runningMax && effectiveTrail > 1) {
+    trail = trail / 2;
+  }
+  return runningMax - ((float)runningMax / effectiveTrail) + ((float)valueToAdd / trail);
+}
+
+moving_light_source_t* movingLightSourceCreate(LayoutData* layoutData, RGB_t* palette, int nColours, uint64_t randomSeed)
+{
+  moving_light_source_t* instance = new moving_light_source_t();
+  instance->palette = palette;
+  instance->nColours = nColours;
+  PRINTLOG("The palette has %d colours:\n", nColours);
+  if(instance->nColours > MAX_PALETTE_COLOURS) {
+    PRINTLOG("There are too many colours in the palette. using only the first %d\n", MAX_PALETTE_COLOURS);
+    instance->nColours = MAX_PALETTE_COLOURS;
+  }
+
+  PRINTLOG("The layout has %d panels\n", layoutData->nPanels);
+  if(LOG_LAYOUT) {
+    for (int i = 0; i < layoutData->nPanels; i++) {
+        PRINTLOG("   Id: %d   X, Y: %lf, %lf\n", layoutData->panels[i].panelId,
+               layoutData->panels[i].shape->getCentroid().x, layoutData->panels[i].shape->getCentroid().y);
+    }
+  }
+
+  // the freqency bin values are seeded from the first few frames so that the plugin starts working reasonably well right away
+  prngSeed(&instance->prng, randomSeed);
+  calibrationInit(&instance->calibration, instance->nColours);
+  bandMapperInit(&instance->bandMapper, BAND_MAPPER_FFT_BINS, instance->nColours);
+
+  instance->panelShown = new RGB_t[layoutData->nPanels];
+  instance->firstFrame = true;
+  float influenceRadius = sqrt((1.0 / INFLUENCE_ERROR_BOUND - 1.0) / FALLOFF);
+  instance->layoutCache = layoutCacheCreate(layoutData, ADJACENT_PANEL_DISTANCE, influenceRadius, false, NULL);
+  splatInit(&instance->splat, layoutData->nPanels, SPLAT_PANELS, influenceRadius * ADJACENT_PANEL_DISTANCE,
+            FALLOFF, ADJACENT_PANEL_DISTANCE);
+  particleInit(&instance->particles, MAX_PARTICLES, instance->layoutCache, HULL_MARGIN * ADJACENT_PANEL_DISTANCE);
+
+  // the wandering source starts in the middle of the layout and never dies
+  const layout_view_t* view = &instance->layoutCache->view;
+  float x = 0;
+  float y = 0;
+  for (int i = 0; i < view->nPanels; i++) {
+    x += view->x[i] / view->nPanels;
+    y += view->y[i] / view->nPanels;
+  }
+  particleSpawn(&instance->particles, x, y, MOVEMENT_SPEED, MOVEMENT_SPEED * 0.6, 0, 255, 255, PARTICLE_IMMORTAL);
+  return instance;
+}
+
+int movingLightSourceFftBins(const moving_light_source_t* instance)
+{
+  return instance->bandMapper.nFftBins;
+}
+
+/**
+  * @description: launch a source from the center of a random panel in a random direction, with the colour
+  * of the frequency band and a speed scaled by the intensity
+  */
+static void addSource(moving_light_source_t* instance, int paletteIndex, float intensity)
+{
+  const layout_view_t* view = &instance->layoutCache->view;
+  if(view->nPanels < 1) {
+    return;
+  }
+  int n1 = prngBounded(&instance->prng, view->nPanels);
+  float angle = prngUnit(&instance->prng) * 2.0 * M_PI;
+  float speed = PARTICLE_SPEED * intensity;
+  const RGB_t* colour = &instance->palette[paletteIndex];
+  particleSpawn(&instance->particles, view->x[n1], view->y[n1], cos(angle) * speed, sin(angle) * speed,
+                colour->R * intensity, colour->G * intensity, colour->B * intensity, PARTICLE_LIFE);
+}
+
+/**
+  * A simple algorithm to detect beats. It finds a strong signal after a period of quietness.
+  * Actually, it doesn't detect just beats. For example, classical music often doesn't have
+  * strong beats but it has strong instrumental sections. Those would also get detected.
+  */
+static int16_t beat_detector(freq_bin* bin)
+{
+  int16_t beat_detected = 0;
+
+  //Check for local maximum and if observed, add to running average
+  if((bin->soundPower + (bin->runningMax / 4) < bin->previousPower) && (bin->previousPower > bin->secondPreviousPower)){
+    bin->runningMax = addToRunningMax(bin->runningMax, bin->previousPower, 4);
+  }
+
+  // update latest minimum.
+  if(bin->soundPower < bin->latest_minimum) {
+    bin->latest_minimum = bin->soundPower;
+  }
+  else if(bin->latest_minimum > 0) {
+    bin->latest_minimum--;
+  }
+
+  // criteria for a "beat"; value must exceed minimum plus a threshold of the runningMax.
+  if(bin->soundPower > bin->latest_minimum + (bin->runningMax * TRIGGER_THRESHOLD)) {
+    bin->latest_minimum = bin->soundPower;
+    beat_detected = 1;
+  }
+
+  // update historical information
+  bin->secondPreviousPower = bin->previousPower;
+  bin->previousPower = bin->soundPower;
+
+  return beat_detected;
+}
+
+/**
+  * @description: seed the detector of every bin from the levels seen during calibration: the minimum starts at the
+  * noise floor and the running max at the peak level, and the last two frames become the detector's history.
+  */
+static void seedFreqBins(moving_light_source_t* instance)
+{
+  const beat_calibration_t* calibration = &instance->calibration;
+  for(int i = 0; i < instance->nColours; i++) {
+    freq_bin* bin = &instance->freq_bins[i];
+    bin->latest_minimum = calibrationNoiseFloor(calibration, i);
+    bin->runningMax = std::max((int)calibrationPeak(calibration, i), 1);
+    bin->maximumTrigger = bin->runningMax;
+    bin->previousPower = calibration->last[i];
+    bin->secondPreviousPower = calibration->secondLast[i];
+  }
+  PRINTLOG("Calibrated after %d frames\n", calibration->frames);
+}
+
+/** Launch a source for every frequency band with a beat in this frame */
+static void detectBeats(moving_light_source_t* instance, const uint8_t* fftBins)
+{
+  // one band per palette colour from the full fft
+  uint8_t bandPowers[MAX_PALETTE_COLOURS];
+  bandMapperApply(&instance->bandMapper, fftBins, bandPowers);
+
+  if(!calibrationDone(&instance->calibration)) {
+    if(calibrationAdd(&instance->calibration, bandPowers)) {
+      seedFreqBins(instance);
+    }
+    return;
+  }
+
+  // Compute the sound power (or volume) in each bin
+  for(int i = 0; i < instance->nColours; i++) {
+    freq_bin* bin = &instance->freq_bins[i];
+    bin->soundPower = bandPowers[i];
+    uint8_t beat_detected = beat_detector(bin);
+
+    if(beat_detected) {
+      if (bin->soundPower > bin->maximumTrigger) {
+        bin->maximumTrigger = bin->soundPower;
+      }
+
+      float intensity = 1.0;
+
+      //calculate an intensity ranging from minimum to 1, using log scale
+      if (bin->soundPower > 1 && bin->runningMax > 1){
+        intensity = ((log((float)bin->soundPower) / log((float)bin->runningMax)) * (1.0 - MINIMUM_INTENSITY)) + MINIMUM_INTENSITY;
+      }
+
+      if (intensity > 1.0) {
+        intensity = 1.0;
+      }
+
+      // launch a new light source for each beat detected
+      addSource(instance, i, intensity);
+    }
+  }
+}
+
+/**
+  * @description: send a panel's colour if it differs from what it shows
+  * @return: the number of frames written, 0 or 1
+  */
+static int emitPanel(moving_light_source_t* instance, int panel, Frame_t* frame)
+{
+  static const RGB_t background = {BASE_COLOR_R, BASE_COLOR_G, BASE_COLOR_B};
+  RGB_t* panelShown = instance->panelShown;
+  int R;
+  int G;
+  int B;
+  splatColour(&instance->splat, panel, &background, &R, &G, &B);
+  if(!instance->firstFrame && R == panelShown[panel].R && G == panelShown[panel].G && B == panelShown[panel].B) {
+    return 0;
+  }
+  panelShown[panel].R = R;
+  panelShown[panel].G = G;
+  panelShown[panel].B = B;
+  frame->panelId = instance->layoutCache->view.panelIds[panel];
+  frame->r = R;
+  frame->g = G;
+  frame->b = B;
+  frame->transTime = TRANSITION_TIME;
+  return 1;
+}
+
+void movingLightSourceFrame(moving_light_source_t* instance, const uint8_t* fftBins, Frame_t* frames, int* nFrames)
+{
+  int nChanged = 0;
+  detectBeats(instance, fftBins);
+
+  const particle_system_t* particles = &instance->particles;
+  splat_buffer_t* splat = &instance->splat;
+  splatBegin(splat);
+  for(int i = 0; i < particles->count; i++) {
+    float intensity = std::min(particles->life[i] / (float)PARTICLE_FADE, 1.0f);
+    splatSource(splat, instance->layoutCache, particles->x[i], particles->y[i],
+                particles->R[i], particles->G[i], particles->B[i], intensity);
+  }
+  // only the panels lit now or a frame ago can have changed, panels that come out the same color are not sent again
+  if(instance->firstFrame) {
+    for(int i = 0; i < splat->nPanels; i++) {
+      nChanged += emitPanel(instance, i, frames + nChanged);
+    }
+  } else {
+    for(int i = 0; i < splat->nTouched; i++) {
+      nChanged += emitPanel(instance, splat->touched[i], frames + nChanged);
+    }
+    for(int i = 0; i < splat->nPrevious; i++) {
+      if(!splat->inFrame[splat->previous[i]]) {
+        nChanged += emitPanel(instance, splat->previous[i], frames + nChanged);
+      }
+    }
+  }
+  instance->firstFrame = false;
+  particleStep(&instance->particles);
+  *nFrames = nChanged;
+}
+
+bool movingLightSourceRestoreDetector(moving_light_source_t* instance, const char* path)
+{
+  if(path == NULL) {
+    return false;
+  }
+  detector_bin_state_t saved[MAX_PALETTE_COLOURS];
+  float tempo = 0; // the effect does not follow the tempo
+  if(!detectorStateLoad(path, saved, instance->nColours, &tempo)) {
+    return false;
+  }
+  for(int i = 0; i < instance->nColours; i++) {
+    freq_bin* bin = &instance->freq_bins[i];
+    bin->latest_minimum = saved[i].latestMinimum;
+    bin->runningMax = std::max(saved[i].runningMax, (uint32_t)1);
+    bin->maximumTrigger = saved[i].maximumTrigger;
+  }
+  calibrationSkip(&instance->calibration);
+  PRINTLOG("Detector state restored from %s\n", path);
+  return true;
+}
+
+void movingLightSourceSaveDetector(const moving_light_source_t* instance, const char* path)
+{
+  if(path == NULL || !calibrationDone(&instance->calibration)) {
+    return; // the constants we started from are not worth keeping
+  }
+  detector_bin_state_t state[MAX_PALETTE_COLOURS];
+  for(int i = 0; i < instance->nColours; i++) {
+    state[i].latestMinimum = instance->freq_bins[i].latest_minimum;
+    state[i].runningMax = instance->freq_bins[i].runningMax;
+    state[i].maximumTrigger = instance->freq_bins[i].maximumTrigger;
+  }
+  detectorStateSave(path, state, instance->nColours, 0);
+}
+
+void movingLightSourceDestroy(moving_light_source_t* instance)
+{
+  if(instance == NULL) {
+    return;
+  }
+  calibrationFree(&instance->calibration);
+  bandMapperFree(&instance->bandMapper);
+  layoutCacheDestroy(instance->layoutCache);
+  splatFree(&instance->splat);
+  particleFree(&instance->particles);
+  delete [] instance->panelShown;
+  delete instance;
+}
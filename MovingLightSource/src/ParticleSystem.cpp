@@ -0,0 +1,207 @@
+/**
+    ParticleSystem.cpp
+
+    Description:
+    The particle arrays, the hull and the vectorised step, see ParticleSystem.h.
+    The hull is Andrew's monotone chain over the four corners of a square of the margin around every centroid,
+    which keeps it a proper polygon even for a single panel or a straight line of them.
+ */
+
+#include "ParticleSystem.h"
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+typedef struct {
+    float x;
+    float y;
+} hull_point_t;
+
+static bool hullPointBefore(const hull_point_t& a, const hull_point_t& b)
+{
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+}
+
+/** Positive when o -> a -> b turns counter clockwise */
+static float cross(const hull_point_t& o, const hull_point_t& a, const hull_point_t& b)
+{
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+/** Build the hull edges of the padded centroids */
+static void buildHull(particle_system_t* system, const layout_view_t* view, float margin)
+{
+    std::vector<hull_point_t> points;
+    for(int p = 0; p < view->nPanels; p++) {
+        for(int corner = 0; corner < 4; corner++) {
+            hull_point_t point;
+            point.x = view->x[p] + (corner & 1 ? margin : -margin);
+            point.y = view->y[p] + (corner & 2 ? margin : -margin);
+            points.push_back(point);
+        }
+    }
+    std::sort(points.begin(), points.end(), hullPointBefore);
+
+    // lower then upper chain, counter clockwise, without repeating the first point at the end
+    std::vector<hull_point_t> hull(2 * points.size());
+    int k = 0;
+    for(size_t i = 0; i < points.size(); i++) {
+        while(k >= 2 && cross(hull[k - 2], hull[k - 1], points[i]) <= 0) {
+            k--;
+        }
+        hull[k++] = points[i];
+    }
+    for(int i = (int)points.size() - 2, lower = k + 1; i >= 0; i--) {
+        while(k >= lower && cross(hull[k - 2], hull[k - 1], points[i]) <= 0) {
+            k--;
+        }
+        hull[k++] = points[i];
+    }
+    int nEdges = std::max(k - 1, 0);
+
+    system->nEdges = nEdges;
+    system->edgeX = new float[nEdges > 0 ? nEdges : 1];
+    system->edgeY = new float[nEdges > 0 ? nEdges : 1];
+    system->edgeOffset = new float[nEdges > 0 ? nEdges : 1];
+    for(int i = 0; i < nEdges; i++) {
+        // the inside of a counter clockwise polygon is on the left, so the outward normal points right
+        float dx = hull[i + 1].x - hull[i].x;
+        float dy = hull[i + 1].y - hull[i].y;
+        float length = sqrt(dx * dx + dy * dy);
+        system->edgeX[i] = dy / length;
+        system->edgeY[i] = -dx / length;
+        system->edgeOffset[i] = system->edgeX[i] * hull[i].x + system->edgeY[i] * hull[i].y;
+    }
+
+    // the largest circle around the centre of the vertices that fits inside every edge
+    float centreX = 0;
+    float centreY = 0;
+    for(int i = 0; i < nEdges; i++) {
+        centreX += hull[i].x / nEdges;
+        centreY += hull[i].y / nEdges;
+    }
+    float innerRadius = nEdges > 0 ? FLT_MAX : 0;
+    for(int i = 0; i < nEdges; i++) {
+        innerRadius = std::min(innerRadius, system->edgeOffset[i] - system->edgeX[i] * centreX - system->edgeY[i] * centreY);
+    }
+    system->centreX = centreX;
+    system->centreY = centreY;
+    system->innerRadius2 = innerRadius * innerRadius;
+}
+
+void particleInit(particle_system_t* system, int capacity, const layout_cache_t* layoutCache, float margin)
+{
+    int padded = (capacity + PARTICLE_LANES - 1) / PARTICLE_LANES * PARTICLE_LANES;
+    system->capacity = capacity;
+    system->count = 0;
+    system->x = new float[padded]();
+    system->y = new float[padded]();
+    system->vx = new float[padded]();
+    system->vy = new float[padded]();
+    system->R = new float[padded]();
+    system->G = new float[padded]();
+    system->B = new float[padded]();
+    system->life = new float[padded]();
+    buildHull(system, &layoutCache->view, margin);
+}
+
+int particleSpawn(particle_system_t* system, float x, float y, float vx, float vy, float R, float G, float B, float life)
+{
+    int i = system->count;
+    if(i < system->capacity) {
+        system->count++;
+    } else {
+        i = std::min_element(system->life, system->life + system->count) - system->life;
+    }
+    system->x[i] = x;
+    system->y[i] = y;
+    system->vx[i] = vx;
+    system->vy[i] = vy;
+    system->R[i] = R;
+    system->G[i] = G;
+    system->B[i] = B;
+    system->life[i] = life;
+    return i;
+}
+
+void particleStep(particle_system_t* system)
+{
+    const particle_select_t one = (particle_select_t)((particle_lanes_t){1.0f, 1.0f, 1.0f, 1.0f});
+    // the last vector runs into the padding, which is moved along harmlessly
+    for(int i = 0; i < system->count; i += PARTICLE_LANES) {
+        particle_lanes_t x = *(particle_lanes_t*)(system->x + i);
+        particle_lanes_t y = *(particle_lanes_t*)(system->y + i);
+        particle_lanes_t vx = *(particle_lanes_t*)(system->vx + i);
+        particle_lanes_t vy = *(particle_lanes_t*)(system->vy + i);
+        x += vx;
+        y += vy;
+        particle_lanes_t dx = x - system->centreX;
+        particle_lanes_t dy = y - system->centreY;
+        particle_select_t inner = dx * dx + dy * dy < system->innerRadius2;
+        bool allInner = inner[0] && inner[1] && inner[2] && inner[3];
+        for(int e = 0; e < system->nEdges && !allInner; e++) {
+            const float edgeX = system->edgeX[e];
+            const float edgeY = system->edgeY[e];
+            // how far past the edge each particle went, and whether it is still heading out; the comparisons
+            // are all ones where true, which leaves 1.0 there and 0 elsewhere
+            particle_lanes_t past = x * edgeX + y * edgeY - system->edgeOffset[e];
+            particle_select_t outside = past > 0.0f;
+            particle_lanes_t heading = vx * edgeX + vy * edgeY;
+            particle_lanes_t mirror = past * 2.0f * (particle_lanes_t)(outside & one);
+            particle_lanes_t reflect = heading * 2.0f * (particle_lanes_t)(outside & (heading > 0.0f) & one);
+            x -= mirror * edgeX;
+            y -= mirror * edgeY;
+            vx -= reflect * edgeX;
+            vy -= reflect * edgeY;
+        }
+        *(particle_lanes_t*)(system->x + i) = x;
+        *(particle_lanes_t*)(system->y + i) = y;
+        *(particle_lanes_t*)(system->vx + i) = vx;
+        *(particle_lanes_t*)(system->vy + i) = vy;
+        *(particle_lanes_t*)(system->life + i) -= 1.0f;
+    }
+
+    // remove the particles that died by moving the last one into their place
+    int i = 0;
+    while(i < system->count) {
+        if(system->life[i] > 0) {
+            i++;
+            continue;
+        }
+        int last = --system->count;
+        system->x[i] = system->x[last];
+        system->y[i] = system->y[last];
+        system->vx[i] = system->vx[last];
+        system->vy[i] = system->vy[last];
+        system->R[i] = system->R[last];
+        system->G[i] = system->G[last];
+        system->B[i] = system->B[last];
+        system->life[i] = system->life[last];
+    }
+}
+
+void particleFree(particle_system_t* system)
+{
+    delete [] system->x;
+    delete [] system->y;
+    delete [] system->vx;
+    delete [] system->vy;
+    delete [] system->R;
+    delete [] system->G;
+    delete [] system->B;
+    delete [] system->life;
+    delete [] system->edgeX;
+    delete [] system->edgeY;
+    delete [] system->edgeOffset;
+    system->x = NULL;
+    system->y = NULL;
+    system->vx = NULL;
+    system->vy = NULL;
+    system->R = NULL;
+    system->G = NULL;
+    system->B = NULL;
+    system->life = NULL;
+    system->edgeX = NULL;
+    system->edgeY = NULL;
+    system->edgeOffset = NULL;
+}
@@ -0,0 +1,148 @@
+/**
+    SplatRenderer.cpp
+
+    Description:
+    Scatters light sources into their nearest panels, see SplatRenderer.h.
+    The nearest panels are found by walking rings of grid cells outward from the source's cell, stopping once
+    the next ring is further away than the furthest of the panels kept so far.
+ */
+
+#include "SplatRenderer.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+void splatInit(splat_buffer_t* buffer, int nPanels, int panelsPerSplat, float radius, float falloff, float adjacentDistance)
+{
+    buffer->nPanels = nPanels;
+    buffer->panelsPerSplat = std::max(1, std::min(panelsPerSplat, SPLAT_MAX_PANELS));
+    buffer->radius = radius;
+    buffer->falloff = falloff;
+    buffer->adjacentDistance = adjacentDistance;
+    buffer->R = new float[nPanels]();
+    buffer->G = new float[nPanels]();
+    buffer->B = new float[nPanels]();
+    buffer->weight = new float[nPanels]();
+    buffer->touched = new int[nPanels];
+    buffer->nTouched = 0;
+    buffer->previous = new int[nPanels];
+    buffer->nPrevious = 0;
+    buffer->inFrame = new bool[nPanels]();
+}
+
+void splatBegin(splat_buffer_t* buffer)
+{
+    std::swap(buffer->touched, buffer->previous);
+    buffer->nPrevious = buffer->nTouched;
+    buffer->nTouched = 0;
+    for(int i = 0; i < buffer->nPrevious; i++) {
+        int p = buffer->previous[i];
+        buffer->R[p] = 0;
+        buffer->G[p] = 0;
+        buffer->B[p] = 0;
+        buffer->weight[p] = 0;
+        buffer->inFrame[p] = false;
+    }
+}
+
+/**
+  * Collect the panelsPerSplat panels nearest to (x, y) within the radius, nearest first.
+  * @return: the number of panels found
+  */
+static int nearestPanels(const splat_buffer_t* buffer, const layout_cache_t* layoutCache, float x, float y, int* panels, float* d2s)
+{
+    const layout_cache_header_t* header = layoutCache->header;
+    const layout_view_t* view = &layoutCache->view;
+    const float cellSize = header->gridCellSize;
+    const float radius2 = buffer->radius * buffer->radius;
+    const int k = buffer->panelsPerSplat;
+    int cx = (int)floor((x - header->gridOriginX) / cellSize);
+    int cy = (int)floor((y - header->gridOriginY) / cellSize);
+    int maxRing = (int)ceil(buffer->radius / cellSize);
+    int found = 0;
+    for(int ring = 0; ring <= maxRing; ring++) {
+        for(int gy = std::max(0, cy - ring); gy <= std::min(header->gridHeight - 1, cy + ring); gy++) {
+            // the inner rows of a ring are only its left and right cells
+            bool edgeRow = gy == cy - ring || gy == cy + ring;
+            int step = edgeRow ? 1 : std::max(1, 2 * ring);
+            for(int gx = cx - ring; gx <= cx + ring; gx += step) {
+                if(gx < 0 || gx >= header->gridWidth) {
+                    continue;
+                }
+                int cell = gy * header->gridWidth + gx;
+                for(int i = layoutCache->gridStart[cell]; i < layoutCache->gridStart[cell + 1]; i++) {
+                    int p = layoutCache->gridPanels[i];
+                    float dx = view->x[p] - x;
+                    float dy = view->y[p] - y;
+                    float d2 = dx * dx + dy * dy;
+                    if(d2 > radius2 || (found == k && d2 >= d2s[k - 1])) {
+                        continue;
+                    }
+                    // insertion into the short sorted list
+                    int j = found < k ? found++ : k - 1;
+                    while(j > 0 && d2s[j - 1] > d2) {
+                        panels[j] = panels[j - 1];
+                        d2s[j] = d2s[j - 1];
+                        j--;
+                    }
+                    panels[j] = p;
+                    d2s[j] = d2;
+                }
+            }
+        }
+        // every cell of the next ring is at least ring cells away from the source
+        float nextRing = ring * cellSize;
+        if(found == k && d2s[k - 1] <= nextRing * nextRing) {
+            break;
+        }
+    }
+    return found;
+}
+
+void splatSource(splat_buffer_t* buffer, const layout_cache_t* layoutCache, float x, float y, float R, float G, float B, float intensity)
+{
+    int panels[SPLAT_MAX_PANELS];
+    float d2s[SPLAT_MAX_PANELS];
+    int found = nearestPanels(buffer, layoutCache, x, y, panels, d2s);
+    float scale = 1.0 / (buffer->adjacentDistance * buffer->adjacentDistance);
+    for(int i = 0; i < found; i++) {
+        int p = panels[i];
+        float weight = intensity / (d2s[i] * scale * buffer->falloff + 1.0);
+        buffer->R[p] += R * weight;
+        buffer->G[p] += G * weight;
+        buffer->B[p] += B * weight;
+        buffer->weight[p] += weight;
+        if(!buffer->inFrame[p]) {
+            buffer->inFrame[p] = true;
+            buffer->touched[buffer->nTouched++] = p;
+        }
+    }
+}
+
+void splatColour(const splat_buffer_t* buffer, int panel, const RGB_t* background, int* R, int* G, int* B)
+{
+    float weight = buffer->weight[panel];
+    float norm = 1.0 / std::max(weight, 1.0f);
+    float keep = 1.0 - std::min(weight, 1.0f);
+    *R = std::min((int)(background->R * keep + buffer->R[panel] * norm), 255);
+    *G = std::min((int)(background->G * keep + buffer->G[panel] * norm), 255);
+    *B = std::min((int)(background->B * keep + buffer->B[panel] * norm), 255);
+}
+
+void splatFree(splat_buffer_t* buffer)
+{
+    delete [] buffer->R;
+    delete [] buffer->G;
+    delete [] buffer->B;
+    delete [] buffer->weight;
+    delete [] buffer->touched;
+    delete [] buffer->previous;
+    delete [] buffer->inFrame;
+    buffer->R = NULL;
+    buffer->G = NULL;
+    buffer->B = NULL;
+    buffer->weight = NULL;
+    buffer->touched = NULL;
+    buffer->previous = NULL;
+    buffer->inFrame = NULL;
+}
@@ -0,0 +1,42 @@
+################################################################################
+# Automatically-generated file. Do not edit!
+################################################################################
+
+# Add inputs and outputs from these tool invocations to the build variables 
+CPP_SRCS += \
+../src/AuroraPlugin.cpp \
+../src/ReactionDiffusion.cpp \
+../src/GrayScott.cpp \
+../src/BeatCalibration.cpp \
+../src/DetectorState.cpp \
+../src/BandMapper.cpp \
+../src/Prng.cpp 
+
+OBJS += \
+./src/AuroraPlugin.o \
+./src/ReactionDiffusion.o \
+./src/GrayScott.o \
+./src/BeatCalibration.o \
+./src/DetectorState.o \
+./src/BandMapper.o \
+./src/Prng.o 
+
+CPP_DEPS += \
+./src/AuroraPlugin.d \
+./src/ReactionDiffusion.d \
+./src/GrayScott.d \
+./src/BeatCalibration.d \
+./src/DetectorState.d \
+./src/BandMapper.d \
+./src/Prng.d 
+
+
+# Each subdirectory must supply rules for building sources it contributes
+src/%.o: ../src/%.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: Cross G++ Compiler'
+	g++ -I../inc -O0 -g3 -Wall -c -fmessage-length=0 -std=c++11 -fPIC -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+
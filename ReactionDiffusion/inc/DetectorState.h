@@ -0,0 +1,55 @@
+/**
+    DetectorState.h
+
+    Description:
+    Keeps what the beat detector has learnt about the room across plugin reloads. The controller reloads the
+    plugin whenever the palette changes or the effect is switched, and every reload used to start the detector
+    from scratch. pluginCleanup writes the levels of every frequency bin and the tempo into a small versioned
+    file, and initPlugin reads them back when the file is recent enough, so detection resumes at full accuracy
+    on the first frame instead of after calibration.
+
+    The file is rejected when its magic, version or size do not match, when it was written for a different
+    number of bins (the bins then cover different frequencies) or when it is older than DETECTOR_STATE_MAX_AGE.
+ */
+
+#ifndef INC_DETECTORSTATE_H_
+#define INC_DETECTORSTATE_H_
+
+#include <stdint.h>
+
+#define DETECTOR_STATE_MAGIC 0x4E424431 // "NBD1"
+#define DETECTOR_STATE_VERSION 2 // bump whenever the layout or the meaning of the file changes, 2: levels are band powers
+#define DETECTOR_STATE_MAX_AGE 600 // seconds after which the room is assumed to have changed
+
+// What the detector knows about one frequency bin
+typedef struct {
+    uint32_t latestMinimum;
+    uint32_t runningMax;
+    uint32_t maximumTrigger;
+} detector_bin_state_t;
+
+// The file starts with this header, followed by nBins detector_bin_state_t
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int64_t savedAt;            // wall clock seconds, so the age survives the plugin process
+    int32_t nBins;
+    float tempo;                // the last tempo estimate, beats per minute
+} detector_state_header_t;
+
+/**
+ * @description: write the detector state to path, through a uniquely named temporary file next to it that is
+ * renamed into place. Missing directories on the way to path are made, readable by the plugin's user only.
+ * @return: true if the file was written
+ */
+bool detectorStateSave(const char* path, const detector_bin_state_t* bins, int nBins, float tempo);
+
+/**
+ * @description: read the detector state back from path
+ * @param bins: filled with nBins entries, left alone if the file is rejected
+ * @param tempo: filled with the saved tempo
+ * @return: true if the file belongs to nBins bins and is no older than DETECTOR_STATE_MAX_AGE
+ */
+bool detectorStateLoad(const char* path, detector_bin_state_t* bins, int nBins, float* tempo);
+
+#endif /* INC_DETECTORSTATE_H_ */
@@ -0,0 +1,84 @@
+/**
+    GrayScott.h
+
+    Description:
+    The Gray-Scott reaction-diffusion system on a square mesh of cells laid under the panels. Every cell holds
+    the concentrations of two chemicals, u and v. Both diffuse, v feeds on u (u + 2v -> 3v), u is fed in at
+    the feed rate and v is removed at the feed plus kill rate. Depending on those two rates v forms spots,
+    stripes or coral that keep growing and splitting.
+
+    Only the cells under a panel take part: the mask of every other cell is 0, which holds it at u = 1, v = 0 so
+    the patterns stay on the panels. A halo of such cells around the mesh and the padding at the end of each row
+    mean the update reads its neighbours without any bounds checks, and each row is computed four cells at a time
+    with GCC vector types, which become SSE or NEON. Several steps can run per frame.
+ */
+
+#ifndef INC_GRAYSCOTT_H_
+#define INC_GRAYSCOTT_H_
+
+#include <stdint.h>
+#include "LayoutProcessingUtils.h"
+
+#define GRAY_SCOTT_LANES 4 // cells computed at once
+#define GRAY_SCOTT_V_FLOOR 1e-6 // less v than this is taken as none, so a fading pattern never turns into slow denormals
+
+// four neighbouring cells of a row, loaded from wherever they start in the row
+typedef float gray_scott_lanes_t __attribute__((vector_size(GRAY_SCOTT_LANES * sizeof(float)), aligned(4), may_alias));
+typedef int32_t gray_scott_select_t __attribute__((vector_size(GRAY_SCOTT_LANES * sizeof(int32_t))));
+
+typedef struct {
+    int width;                  // cells per row
+    int height;                 // rows
+    int stride;                 // floats per row: a halo cell either side and width rounded up to whole vectors
+    float originX;              // world position of the corner of cell (0, 0)
+    float originY;
+    float cellSize;             // width of a cell in layout units
+    float* u;                   // cell (x, y) is at (y + 1) * stride + x + 1, the first and last rows are halo
+    float* v;
+    float* nextU;               // the next step is built here and then swapped in
+    float* nextV;
+    float* mask;                // 1 for the cells that take part, 0 for the rest, the halo and the padding
+    float diffusionU;           // share of the difference to each of the four neighbours a cell takes per step
+    float diffusionV;
+    float feed;                 // u fed in per step, in proportion to how far u is below 1
+    float kill;                 // v removed per step on top of the feed rate
+} gray_scott_t;
+
+/**
+ * @description: make a mesh covering the panel centroids of a layout with every cell at u = 1, v = 0 and no
+ * cell taking part yet, see grayScottSetMask()
+ * @param cellSize: width of a cell in layout units
+ * @param margin: cells of extra room around the outermost centroids
+ */
+void grayScottInit(gray_scott_t* mesh, LayoutData* layoutData, float cellSize, int margin);
+
+/**
+ * @description: free the mesh
+ */
+void grayScottFree(gray_scott_t* mesh);
+
+/**
+ * @description: the index of cell (x, y) in the u, v and mask arrays
+ */
+static inline int grayScottIndex(const gray_scott_t* mesh, int x, int y)
+{
+    return (y + 1) * mesh->stride + x + 1;
+}
+
+/**
+ * @description: the cell containing a point
+ * @return: false if the point is outside the mesh
+ */
+bool grayScottCellAt(const gray_scott_t* mesh, float x, float y, int* cellX, int* cellY);
+
+/**
+ * @description: let a cell take part in the reaction or hold it at u = 1, v = 0
+ */
+void grayScottSetMask(gray_scott_t* mesh, int x, int y, bool inside);
+
+/**
+ * @description: advance the whole mesh by a number of steps with the current feed and kill rates
+ */
+void grayScottStep(gray_scott_t* mesh, int steps);
+
+#endif /* INC_GRAYSCOTT_H_ */
@@ -0,0 +1,58 @@
+/**
+    ReactionDiffusion.h
+
+    Description:
+    The ReactionDiffusion effect as a self contained instance. The reaction-diffusion mesh, the frequency bin
+    history and the beat detector calibration hang off a reaction_diffusion_t, and the instance never calls into
+    the host: the fft bins of a frame are handed in by the caller. AuroraPlugin.cpp keeps one instance behind the
+    initPlugin/getPluginFrame/pluginCleanup ABI, the simulator and benchmarks can create as many as they like.
+ */
+
+#ifndef INC_REACTIONDIFFUSION_H_
+#define INC_REACTIONDIFFUSION_H_
+
+#include <stdint.h>
+#include "AuroraPlugin.h"
+#include "ColorUtils.h"
+#include "LayoutProcessingUtils.h"
+
+struct reaction_diffusion_t;
+
+/**
+ * @description: create an instance for a layout and palette. Both have to outlive the instance.
+ * @param randomSeed: seeds the instance's random numbers, the same seed replays the same run
+ */
+reaction_diffusion_t* reactionDiffusionCreate(LayoutData* layoutData, RGB_t* palette, int nColours, uint64_t randomSeed);
+
+/**
+ * @description: number of fft bins reactionDiffusionFrame() reads
+ */
+int reactionDiffusionFftBins(const reaction_diffusion_t* instance);
+
+/**
+ * @description: advance the reaction by one frame and render every panel
+ * @param fftBins: reactionDiffusionFftBins() bins sampled from the host for this frame
+ * @param frames: buffer with room for one frame per panel
+ * @param nFrames: filled with the number of frames written
+ */
+void reactionDiffusionFrame(reaction_diffusion_t* instance, const uint8_t* fftBins, Frame_t* frames, int* nFrames);
+
+/**
+ * @description: seed the beat detector from a state saved by reactionDiffusionSaveDetector(), skipping the
+ * calibration. Call it right after reactionDiffusionCreate(). A NULL path is ignored.
+ * @return: true if the state was recent enough and saved for the same number of fft bins
+ */
+bool reactionDiffusionRestoreDetector(reaction_diffusion_t* instance, const char* path);
+
+/**
+ * @description: save what the beat detector has learnt so the next instance can start from it. Nothing is
+ * written before the detector has been calibrated or when path is NULL.
+ */
+void reactionDiffusionSaveDetector(const reaction_diffusion_t* instance, const char* path);
+
+/**
+ * @description: free the instance. NULL is ignored.
+ */
+void reactionDiffusionDestroy(reaction_diffusion_t* instance);
+
+#endif /* INC_REACTIONDIFFUSION_H_ */
@@ -0,0 +1,97 @@
+/**
+    Copyright 2017 Nanoleaf Ltd.
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http:www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    AuroraPlugin.cpp
+
+    Created on: Jul 23, 2017
+    Author: Elliot Ford
+
+    Description:
+    Beat Detection, FFT to light source color and Panel Color calculations based on FrequncyStars by Nathan Dyck.
+    A Gray-Scott reaction-diffusion system runs under the panels and grows spots, stripes and coral.
+    Whenever a beat is detected the reaction is seeded at the center of one of the panels and the music drives how fast the patterns grow.
+    The effect itself lives in ReactionDiffusion.cpp, this file keeps a single instance of it behind the plugin ABI.
+ */
+
+
+#include "AuroraPlugin.h"
+#include "LayoutProcessingUtils.h"
+#include "ColorUtils.h"
+#include "DataManager.h"
+#include "PluginFeatures.h"
+#include "ReactionDiffusion.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    void initPlugin();
+    void getPluginFrame(Frame_t* frames, int* nFrames, int* sleepTime);
+    void pluginCleanup();
+
+#ifdef __cplusplus
+}
+#endif
+
+#define DETECTOR_STATE_PATH "/var/lib/nanoleaf/plugins/ReactionDiffusion/detector.state" // the beat detector state is kept here between loads, in the plugin's own directory. NULL disables it
+#define RANDOM_SEED 48 // seeds where the reaction is seeded, fixed so every load plays the same way
+
+static reaction_diffusion_t* instance = NULL; // the effect this plugin shows
+
+/**
+ * @description: Initialize the plugin. Called once, when the plugin is loaded.
+ * This function can be used to load the LayoutData and the colorPalette from the DataManager.
+ * Any allocation, if done here, should be deallocated in the plugin cleanup function
+ *
+ * @param isSoundPlugin: Setting this flag will indicate that it is a sound plugin, and accordingly
+ * sound data will be passed in. If not set, the plugin will be considered an effects plugin
+ *
+ */
+void initPlugin() {
+    RGB_t* paletteColours = NULL;
+    int nColours = 0;
+    getColorPalette(&paletteColours, &nColours);  // grab the palette colours
+    instance = reactionDiffusionCreate(getLayoutData(), paletteColours, nColours, RANDOM_SEED);
+    reactionDiffusionRestoreDetector(instance, DETECTOR_STATE_PATH);
+    enableFft(reactionDiffusionFftBins(instance));
+}
+
+/**
+ * @description: this the 'main' function that gives a frame to the Aurora to display onto the panels
+ * If the plugin is an effects plugin the soundFeature buffer will be NULL.
+ * If the plugin is a sound visualization plugin, the sleepTime variable will be NULL and is not required to be
+ * filled in
+ * This function, if is an effects plugin, can specify the interval it is to be called at through the sleepTime variable
+ * if its a sound visualization plugin, this function is called at an interval of 50ms or more.
+ *
+ * @param soundFeature: Carries the processed sound data from the soundModule, NULL if effects plugin
+ * @param frames: a pre-allocated buffer of the Frame_t structure to fill up with RGB values to show on panels.
+ * Maximum size of this buffer is equal to the number of panels
+ * @param nFrames: fill with the number of frames in frames
+ * @param sleepTime: specify interval after which this function is called again, NULL if sound visualization plugin
+ */
+void getPluginFrame(Frame_t* frames, int* nFrames, int* sleepTime) {
+    reactionDiffusionFrame(instance, getFftBins(), frames, nFrames);
+}
+
+/**
+ * @description: called once when the plugin is being closed.
+ * Do all deallocation for memory allocated in initplugin here
+ */
+void pluginCleanup() {
+    reactionDiffusionSaveDetector(instance, DETECTOR_STATE_PATH);
+    reactionDiffusionDestroy(instance);
+    instance = NULL;
+}
@@ -0,0 +1,115 @@
+/**
+    GrayScott.cpp
+
+    Description:
+    The vectorised Gray-Scott update, see GrayScott.h.
+    The four neighbours are read with unaligned loads one cell and one row away from the centre, and the
+    mask folds "does this cell take part" into the arithmetic so there is no branch per cell.
+ */
+
+#include "GrayScott.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+void grayScottInit(gray_scott_t* mesh, LayoutData* layoutData, float cellSize, int margin)
+{
+    float minX = 0;
+    float minY = 0;
+    float maxX = 0;
+    float maxY = 0;
+    for(int i = 0; i < layoutData->nPanels; i++) {
+        const Point& centroid = layoutData->panels[i].shape->getCentroid();
+        if(i == 0 || centroid.x < minX) minX = centroid.x;
+        if(i == 0 || centroid.y < minY) minY = centroid.y;
+        if(i == 0 || centroid.x > maxX) maxX = centroid.x;
+        if(i == 0 || centroid.y > maxY) maxY = centroid.y;
+    }
+    mesh->cellSize = cellSize;
+    mesh->originX = minX - margin * cellSize;
+    mesh->originY = minY - margin * cellSize;
+    mesh->width = (int)((maxX - minX) / cellSize) + 2 * margin + 1;
+    mesh->height = (int)((maxY - minY) / cellSize) + 2 * margin + 1;
+    mesh->stride = (mesh->width + GRAY_SCOTT_LANES - 1) / GRAY_SCOTT_LANES * GRAY_SCOTT_LANES + 2;
+    int cells = (mesh->height + 2) * mesh->stride;
+    mesh->u = new float[cells];
+    mesh->v = new float[cells]();
+    mesh->nextU = new float[cells];
+    mesh->nextV = new float[cells]();
+    mesh->mask = new float[cells]();
+    std::fill(mesh->u, mesh->u + cells, 1.0f);
+    std::fill(mesh->nextU, mesh->nextU + cells, 1.0f);
+}
+
+void grayScottFree(gray_scott_t* mesh)
+{
+    delete [] mesh->u;
+    delete [] mesh->v;
+    delete [] mesh->nextU;
+    delete [] mesh->nextV;
+    delete [] mesh->mask;
+    mesh->u = NULL;
+    mesh->v = NULL;
+    mesh->nextU = NULL;
+    mesh->nextV = NULL;
+    mesh->mask = NULL;
+}
+
+bool grayScottCellAt(const gray_scott_t* mesh, float x, float y, int* cellX, int* cellY)
+{
+    int cx = (int)floor((x - mesh->originX) / mesh->cellSize);
+    int cy = (int)floor((y - mesh->originY) / mesh->cellSize);
+    if(cx < 0 || cy < 0 || cx >= mesh->width || cy >= mesh->height) {
+        return false;
+    }
+    *cellX = cx;
+    *cellY = cy;
+    return true;
+}
+
+void grayScottSetMask(gray_scott_t* mesh, int x, int y, bool inside)
+{
+    int i = grayScottIndex(mesh, x, y);
+    mesh->mask[i] = inside ? 1.0 : 0.0;
+    if(!inside) {
+        mesh->u[i] = 1.0;
+        mesh->v[i] = 0.0;
+    }
+}
+
+void grayScottStep(gray_scott_t* mesh, int steps)
+{
+    const int stride = mesh->stride;
+    const float* mask = mesh->mask;
+    const float diffusionU = mesh->diffusionU;
+    const float diffusionV = mesh->diffusionV;
+    const float feed = mesh->feed;
+    const float feedKill = mesh->feed + mesh->kill;
+    for(int s = 0; s < steps; s++) {
+        const float* u = mesh->u;
+        const float* v = mesh->v;
+        float* nextU = mesh->nextU;
+        float* nextV = mesh->nextV;
+        for(int y = 1; y <= mesh->height; y++) {
+            // the last vector of a row runs into the padding, whose mask keeps it at u = 1, v = 0
+            for(int i = y * stride + 1; i < y * stride + 1 + mesh->width; i += GRAY_SCOTT_LANES) {
+                gray_scott_lanes_t centreU = *(const gray_scott_lanes_t*)(u + i);
+                gray_scott_lanes_t centreV = *(const gray_scott_lanes_t*)(v + i);
+                gray_scott_lanes_t laplaceU = *(const gray_scott_lanes_t*)(u + i - 1) + *(const gray_scott_lanes_t*)(u + i + 1)
+                    + *(const gray_scott_lanes_t*)(u + i - stride) + *(const gray_scott_lanes_t*)(u + i + stride) - centreU * 4.0f;
+                gray_scott_lanes_t laplaceV = *(const gray_scott_lanes_t*)(v + i - 1) + *(const gray_scott_lanes_t*)(v + i + 1)
+                    + *(const gray_scott_lanes_t*)(v + i - stride) + *(const gray_scott_lanes_t*)(v + i + stride) - centreV * 4.0f;
+                gray_scott_lanes_t reaction = centreU * centreV * centreV;
+                gray_scott_lanes_t inside = *(const gray_scott_lanes_t*)(mask + i);
+                gray_scott_lanes_t newU = centreU + laplaceU * diffusionU - reaction + (1.0f - centreU) * feed;
+                gray_scott_lanes_t newV = centreV + laplaceV * diffusionV + reaction - centreV * feedKill;
+                *(gray_scott_lanes_t*)(nextU + i) = (newU - 1.0f) * inside + 1.0f;
+                // the comparison is all ones where v is worth keeping, which leaves the mask's 1.0 there and 0 elsewhere
+                gray_scott_select_t keep = (newV > (float)GRAY_SCOTT_V_FLOOR) & (gray_scott_select_t)inside;
+                *(gray_scott_lanes_t*)(nextV + i) = newV * (gray_scott_lanes_t)keep;
+            }
+        }
+        std::swap(mesh->u, mesh->nextU);
+        std::swap(mesh->v, mesh->nextV);
+    }
+}
@@ -0,0 +1,431 @@
+/**
+    ReactionDiffusion.cpp
+
+    Description:
+    Beat Detection, FFT to light source color and Panel Color calculations based on FrequncyStars by Nathan Dyck.
+    A Gray-Scott reaction runs on a mesh of cells under the panels (see GrayScott.h), several steps per frame.
+    Whenever a beat is detected some v is seeded at the centre of a random panel, which takes on the colour of the
+    frequency band, and the beat excites the reaction: the feed and kill rates move from a calm setting, where
+    the patterns thin out, towards one where they grow and split, and settle back as the music calms down.
+    Each panel shows its colour scaled by the average v of the cells it covers, weighted by how much of each
+    cell lies inside the panel.
+    All state lives in a reaction_diffusion_t so any number of instances can run side by side, see ReactionDiffusion.h.
+ */
+
+#include "ReactionDiffusion.h"
+#include <stdlib.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "Logger.h"
+#include "BeatCalibration.h"
+#include "DetectorState.h"
+#include "BandMapper.h"
+#include "Prng.h"
+#include "GrayScott.h"
+#include <vector>
+#include <algorithm>
+
+#define MAX_PALETTE_COLOURS 7   // if more colours then this, we will use just the first this many
+#define BASE_COLOUR_R 0 // these three settings defined the background colour; set to black
+#define BASE_COLOUR_G 0
+#define BASE_COLOUR_B 0
+#define ADJACENT_PANEL_DISTANCE 86.599995   // hard coded distance between adjacent panels; this ideally should be autodetected
+#define TRANSITION_TIME 1  // the transition time to send to panels; set to 100ms currently
+#define LOG_LAYOUT false // print every palette colour and panel position on start-up
+#define MINIMUM_INTENSITY 0.2  // the minimum intensity of a source
+#define TRIGGER_THRESHOLD 0.7 // used to calculate whether to add a source
+#define RD_CELLS_PER_PANEL 6 // mesh cells across the distance between two adjacent panels
+#define RD_SUBSAMPLES 2 // points per cell side tested against a panel's shape to find how much of the cell it covers
+#define RD_STEPS_PER_FRAME 12 // reaction steps per frame
+#define RD_DIFFUSION_U 0.2 // diffusion of u and v per step, 4 * RD_DIFFUSION_U has to stay below 1
+#define RD_DIFFUSION_V 0.1
+#define RD_CALM_FEED 0.030 // feed and kill rates without any beats, the patterns thin out
+#define RD_CALM_KILL 0.068
+#define RD_EXCITED_FEED 0.037 // feed and kill rates at full excitement, the patterns grow and split
+#define RD_EXCITED_KILL 0.060
+#define RD_EXCITEMENT_PER_BEAT 0.3 // excitement added by a beat of full intensity, it goes up to 1
+#define RD_EXCITEMENT_DECAY 0.97 // the excitement is multiplied by this every frame
+#define RD_SEED_RADIUS 0.5 // a beat seeds v in the cells this many panel distances from the centroid
+#define RD_SEED_U 0.5 // the concentrations a beat leaves in the cells it seeds
+#define RD_SEED_V 0.25
+#define RD_FULL_V 0.3 // a panel shows its full colour once the average v it covers reaches this
+
+// A mesh cell a panel covers, with the share of the panel it makes up
+typedef struct {
+    int cell;                   // index into the mesh arrays, see grayScottIndex()
+    float weight;               // the weights of a panel's cells add up to 1
+    bool core;                  // close enough to the centroid to be seeded by a beat
+} mesh_footprint_t;
+
+/** Here we store the information accociated with each frequency bin. This
+ allows for tracking a degree of historical information.
+ */
+typedef struct {
+    uint32_t latest_minimum;
+    uint32_t soundPower;
+    int16_t colour;
+    uint32_t runningMax;
+    uint32_t runningMin;
+    uint32_t maximumTrigger;
+    uint32_t previousPower;
+    uint32_t secondPreviousPower;
+} freq_bin;
+
+struct reaction_diffusion_t {
+    RGB_t* paletteColours;          // the colour palette, owned by the caller
+    int nColours;                   // the number of colours of the palette in use
+    LayoutData* layoutData;         // the panel layout, owned by the caller
+    gray_scott_t mesh;              // the reaction
+    int* footprintStart;            // the cells panel p covers are footprint[footprintStart[p]] up to footprint[footprintStart[p + 1]]
+    mesh_footprint_t* footprint;
+    RGB_t* panelColours;            // the colour each panel shows v in
+    float excitement;               // 0 calm to 1 excited, raised by beats
+    prng_t prng;                    // this instance's random numbers
+    freq_bin freq_bins[MAX_PALETTE_COLOURS]; // this is our array for frequency bin historical information.
+    beat_calibration_t calibration; // levels of the first frames, the frequency bins are seeded from them
+    band_mapper_t bandMapper;       // maps the fft onto one band per palette colour
+};
+
+/**
+  * @description: add a value to a running max.
+  * @param: runningMax is current runningMax, valueToAdd is added to runningMax, effectiveTrail
+  *         defines how many values are effectively tracked. Note this is an approximation.
+  * @return: int returned as new runningMax.
+  */
+static int addToRunningMax(int runningMax, int valueToAdd, int effectiveTrail) {
+    int trail = effectiveTrail;
+    if (valueToAdd > runningMax && effectiveTrail > 1) {
+        trail = trail / 2;
+    }
+    return runningMax - ((float)runningMax / effectiveTrail) + ((float)valueToAdd / trail);
+}
+
+/**
+  * @description: list the mesh cells every panel covers, weighted by the share of each cell inside the panel's
+  * shape, and let exactly those cells take part in the reaction. A panel too small to cover the centre of any
+  * sample point gets the cell under its centroid.
+  */
+static void buildFootprints(reaction_diffusion_t* instance)
+{
+    LayoutData* layoutData = instance->layoutData;
+    gray_scott_t* mesh = &instance->mesh;
+    int reach = (int)ceil(ADJACENT_PANEL_DISTANCE / mesh->cellSize) + 1;
+    std::vector<mesh_footprint_t> footprint;
+    instance->footprintStart = new int[layoutData->nPanels + 1];
+    for(int p = 0; p < layoutData->nPanels; p++) {
+        instance->footprintStart[p] = footprint.size();
+        Shape* shape = layoutData->panels[p].shape;
+        const Point& centroid = shape->getCentroid();
+        int cx;
+        int cy;
+        if(!grayScottCellAt(mesh, centroid.x, centroid.y, &cx, &cy)) {
+            continue;
+        }
+        float total = 0;
+        for(int y = std::max(cy - reach, 0); y <= std::min(cy + reach, mesh->height - 1); y++) {
+            for(int x = std::max(cx - reach, 0); x <= std::min(cx + reach, mesh->width - 1); x++) {
+                int inside = 0;
+                for(int sy = 0; sy < RD_SUBSAMPLES; sy++) {
+                    for(int sx = 0; sx < RD_SUBSAMPLES; sx++) {
+                        Point sample(mesh->originX + (x + (sx + 0.5) / RD_SUBSAMPLES) * mesh->cellSize,
+                                     mesh->originY + (y + (sy + 0.5) / RD_SUBSAMPLES) * mesh->cellSize);
+                        inside += shape->isPointInsideShape(sample);
+                    }
+                }
+                if(inside == 0) {
+                    continue;
+                }
+                float dx = (mesh->originX + (x + 0.5) * mesh->cellSize - centroid.x) / ADJACENT_PANEL_DISTANCE;
+                float dy = (mesh->originY + (y + 0.5) * mesh->cellSize - centroid.y) / ADJACENT_PANEL_DISTANCE;
+                mesh_footprint_t entry;
+                entry.cell = grayScottIndex(mesh, x, y);
+                entry.weight = (float)inside / (RD_SUBSAMPLES * RD_SUBSAMPLES);
+                entry.core = dx * dx + dy * dy <= RD_SEED_RADIUS * RD_SEED_RADIUS;
+                footprint.push_back(entry);
+                grayScottSetMask(mesh, x, y, true);
+                total += entry.weight;
+            }
+        }
+        if(total == 0) {
+            mesh_footprint_t entry;
+            entry.cell = grayScottIndex(mesh, cx, cy);
+            entry.weight = 1.0;
+            entry.core = true;
+            footprint.push_back(entry);
+            grayScottSetMask(mesh, cx, cy, true);
+            total = 1.0;
+        }
+        for(size_t i = instance->footprintStart[p]; i < footprint.size(); i++) {
+            footprint[i].weight /= total;
+        }
+    }
+    instance->footprintStart[layoutData->nPanels] = footprint.size();
+    instance->footprint = new mesh_footprint_t[footprint.size() > 0 ? footprint.size() : 1];
+    std::copy(footprint.begin(), footprint.end(), instance->footprint);
+}
+
+reaction_diffusion_t* reactionDiffusionCreate(LayoutData* layoutData, RGB_t* palette, int nColours, uint64_t randomSeed)
+{
+    reaction_diffusion_t* instance = new reaction_diffusion_t();
+    instance->paletteColours = palette;
+    instance->nColours = nColours;
+    PRINTLOG("The palette has %d colours:\n", nColours);
+    if(instance->nColours > MAX_PALETTE_COLOURS) {
+        PRINTLOG("There are too many colours in the palette. using only the first %d\n", MAX_PALETTE_COLOURS);
+        instance->nColours = MAX_PALETTE_COLOURS;
+    }
+
+    if(LOG_LAYOUT) {
+        for (int i = 0; i < instance->nColours; i++) {
+            PRINTLOG("   %d %d %d\n", palette[i].R, palette[i].G, palette[i].B);
+        }
+    }
+
+    instance->layoutData = layoutData;
+
+    PRINTLOG("The layout has %d panels\n", layoutData->nPanels);
+    if(LOG_LAYOUT) {
+        for (int i = 0; i < layoutData->nPanels; i++) {
+            PRINTLOG("   Id: %d   X, Y: %lf, %lf\n", layoutData->panels[i].panelId,
+                   layoutData->panels[i].shape->getCentroid().x, layoutData->panels[i].shape->getCentroid().y);
+        }
+    }
+
+    // the freqency bin values are seeded from the first few frames so that the plugin starts working reasonably well right away
+    prngSeed(&instance->prng, randomSeed);
+    calibrationInit(&instance->calibration, instance->nColours);
+    bandMapperInit(&instance->bandMapper, BAND_MAPPER_FFT_BINS, instance->nColours);
+
+    // the mesh reaches a panel distance past the outermost centroids so it covers the whole of every panel
+    grayScottInit(&instance->mesh, layoutData, ADJACENT_PANEL_DISTANCE / RD_CELLS_PER_PANEL, RD_CELLS_PER_PANEL + 1);
+    instance->mesh.diffusionU = RD_DIFFUSION_U;
+    instance->mesh.diffusionV = RD_DIFFUSION_V;
+    instance->mesh.feed = RD_CALM_FEED;
+    instance->mesh.kill = RD_CALM_KILL;
+    buildFootprints(instance);
+
+    // every panel starts out in a random palette colour until a beat lands on it
+    instance->panelColours = new RGB_t[layoutData->nPanels]();
+    for(int p = 0; p < layoutData->nPanels && instance->nColours > 0; p++) {
+        instance->panelColours[p] = palette[prngBounded(&instance->prng, instance->nColours)];
+    }
+    PRINTLOG("The mesh has %d x %d cells\n", instance->mesh.width, instance->mesh.height);
+    return instance;
+}
+
+int reactionDiffusionFftBins(const reaction_diffusion_t* instance)
+{
+    return instance->bandMapper.nFftBins;
+}
+
+/**
+  * @description: This function will render the colour of panel p from the average v of the cells it covers.
+  */
+static void renderPanel(const reaction_diffusion_t* instance, int p, int *returnR, int *returnG, int *returnB)
+{
+    const float* v = instance->mesh.v;
+    float level = 0;
+    for(int i = instance->footprintStart[p]; i < instance->footprintStart[p + 1]; i++) {
+        level += v[instance->footprint[i].cell] * instance->footprint[i].weight;
+    }
+    level = std::min(level / (float)RD_FULL_V, 1.0f);
+    const RGB_t* colour = &instance->panelColours[p];
+    *returnR = BASE_COLOUR_R + (int)(colour->R * level);
+    *returnG = BASE_COLOUR_G + (int)(colour->G * level);
+    *returnB = BASE_COLOUR_B + (int)(colour->B * level);
+}
+
+/**
+  * @description: Seeds v at the centre of a random panel and gives the panel the colour of the frequency band,
+  * scaled by the intensity. The beat also excites the reaction.
+*/
+static void addSource(reaction_diffusion_t* instance, int paletteIndex, float intensity)
+{
+    // we need at least two panels to do anything meaningful in here
+    if(instance->layoutData->nPanels < 2) {
+        return;
+    }
+    int n1 = prngBounded(&instance->prng, instance->layoutData->nPanels);
+    RGB_t* colour = &instance->panelColours[n1];
+    colour->R = instance->paletteColours[paletteIndex].R * intensity;
+    colour->G = instance->paletteColours[paletteIndex].G * intensity;
+    colour->B = instance->paletteColours[paletteIndex].B * intensity;
+
+    gray_scott_t* mesh = &instance->mesh;
+    for(int i = instance->footprintStart[n1]; i < instance->footprintStart[n1 + 1]; i++) {
+        if(instance->footprint[i].core) {
+            mesh->u[instance->footprint[i].cell] = RD_SEED_U;
+            mesh->v[instance->footprint[i].cell] = RD_SEED_V;
+        }
+    }
+    instance->excitement = std::min(instance->excitement + intensity * (float)RD_EXCITEMENT_PER_BEAT, 1.0f);
+}
+
+/**
+  * A simple algorithm to detect beats. It finds a strong signal after a period of quietness.
+  * Actually, it doesn't detect just beats. For example, classical music often doesn't have
+  * strong beats but it has strong instrumental sections. Those would also get detected.
+  */
+static int16_t beat_detector(freq_bin* bin)
+{
+    int16_t beat_detected = 0;
+
+    //Check for local maximum and if observed, add to running average
+    if((bin->soundPower + (bin->runningMax / 4) < bin->previousPower) && (bin->previousPower > bin->secondPreviousPower)){
+        bin->runningMax = addToRunningMax(bin->runningMax, bin->previousPower, 4);
+    }
+
+    // update latest minimum.
+    if(bin->soundPower < bin->latest_minimum) {
+        bin->latest_minimum = bin->soundPower;
+    }
+    else if(bin->latest_minimum > 0) {
+        bin->latest_minimum--;
+    }
+
+    // criteria for a "beat"; value must exceed minimum plus a threshold of the runningMax.
+    if(bin->soundPower > bin->latest_minimum + (bin->runningMax * TRIGGER_THRESHOLD)) {
+        bin->latest_minimum = bin->soundPower;
+        beat_detected = 1;
+    }
+
+    // update historical information
+    bin->secondPreviousPower = bin->previousPower;
+    bin->previousPower = bin->soundPower;
+
+    return beat_detected;
+}
+
+/**
+  * @description: seed the detector of every bin from the levels seen during calibration: the minimum starts at the
+  * noise floor and the running max at the peak level, and the last two frames become the detector's history.
+  */
+static void seedFreqBins(reaction_diffusion_t* instance)
+{
+    const beat_calibration_t* calibration = &instance->calibration;
+    for(int i = 0; i < instance->nColours; i++) {
+        freq_bin* bin = &instance->freq_bins[i];
+        bin->latest_minimum = calibrationNoiseFloor(calibration, i);
+        bin->runningMax = std::max((int)calibrationPeak(calibration, i), 1);
+        bin->maximumTrigger = bin->runningMax;
+        bin->previousPower = calibration->last[i];
+        bin->secondPreviousPower = calibration->secondLast[i];
+    }
+    PRINTLOG("Calibrated after %d frames\n", calibration->frames);
+}
+
+void reactionDiffusionFrame(reaction_diffusion_t* instance, const uint8_t* fftBins, Frame_t* frames, int* nFrames)
+{
+    int R;
+    int G;
+    int B;
+    int i;
+    *nFrames = 0;
+
+    // one band per palette colour from the full fft
+    uint8_t bandPowers[MAX_PALETTE_COLOURS];
+    bandMapperApply(&instance->bandMapper, fftBins, bandPowers);
+
+    if(!calibrationDone(&instance->calibration)) {
+        if(calibrationAdd(&instance->calibration, bandPowers)) {
+            seedFreqBins(instance);
+        }
+        return;
+    }
+
+    // Compute the sound power (or volume) in each bin
+    for(i = 0; i < instance->nColours; i++) {
+        freq_bin* bin = &instance->freq_bins[i];
+        bin->soundPower = bandPowers[i];
+        uint8_t beat_detected = beat_detector(bin);
+
+        if(beat_detected) {
+            if (bin->soundPower > bin->maximumTrigger) {
+                bin->maximumTrigger = bin->soundPower;
+            }
+
+            float intensity = 1.0;
+
+            //calculate an intensity ranging from minimum to 1, using log scale
+            if (bin->soundPower > 1 && bin->runningMax > 1){
+                intensity = ((log((float)bin->soundPower) / log((float)bin->runningMax)) * (1.0 - MINIMUM_INTENSITY)) + MINIMUM_INTENSITY;
+            }
+
+            if (intensity > 1.0) {
+                intensity = 1.0;
+            }
+
+            // seed the reaction for each beat detected
+            addSource(instance, i, intensity);
+        }
+    }
+
+    // the excitement slides the rates between the calm and the excited setting
+    gray_scott_t* mesh = &instance->mesh;
+    mesh->feed = RD_CALM_FEED + (RD_EXCITED_FEED - RD_CALM_FEED) * instance->excitement;
+    mesh->kill = RD_CALM_KILL + (RD_EXCITED_KILL - RD_CALM_KILL) * instance->excitement;
+    instance->excitement *= RD_EXCITEMENT_DECAY;
+    grayScottStep(mesh, RD_STEPS_PER_FRAME);
+
+    // iterate through all the pals and render each one
+    LayoutData* layoutData = instance->layoutData;
+    for(i = 0; i < layoutData->nPanels; i++) {
+        renderPanel(instance, i, &R, &G, &B);
+        frames[i].panelId = layoutData->panels[i].panelId;
+        frames[i].r = R;
+        frames[i].g = G;
+        frames[i].b = B;
+        frames[i].transTime = TRANSITION_TIME;
+    }
+    *nFrames = layoutData->nPanels;
+}
+
+bool reactionDiffusionRestoreDetector(reaction_diffusion_t* instance, const char* path)
+{
+    if(path == NULL) {
+        return false;
+    }
+    detector_bin_state_t saved[MAX_PALETTE_COLOURS];
+    float tempo = 0; // the effect does not follow the tempo
+    if(!detectorStateLoad(path, saved, instance->nColours, &tempo)) {
+        return false;
+    }
+    for(int i = 0; i < instance->nColours; i++) {
+        freq_bin* bin = &instance->freq_bins[i];
+        bin->latest_minimum = saved[i].latestMinimum;
+        bin->runningMax = std::max(saved[i].runningMax, (uint32_t)1);
+        bin->maximumTrigger = saved[i].maximumTrigger;
+    }
+    calibrationSkip(&instance->calibration);
+    PRINTLOG("Detector state restored from %s\n", path);
+    return true;
+}
+
+void reactionDiffusionSaveDetector(const reaction_diffusion_t* instance, const char* path)
+{
+    if(path == NULL || !calibrationDone(&instance->calibration)) {
+        return; // the constants we started from are not worth keeping
+    }
+    detector_bin_state_t state[MAX_PALETTE_COLOURS];
+    for(int i = 0; i < instance->nColours; i++) {
+        state[i].latestMinimum = instance->freq_bins[i].latest_minimum;
+        state[i].runningMax = instance->freq_bins[i].runningMax;
+        state[i].maximumTrigger = instance->freq_bins[i].maximumTrigger;
+    }
+    detectorStateSave(path, state, instance->nColours, 0);
+}
+
+void reactionDiffusionDestroy(reaction_diffusion_t* instance)
+{
+    if(instance == NULL) {
+        return;
+    }
+    calibrationFree(&instance->calibration);
+    bandMapperFree(&instance->bandMapper);
+    grayScottFree(&instance->mesh);
+    delete [] instance->footprintStart;
+    delete [] instance->footprint;
+    delete [] instance->panelColours;
+    delete instance;
+}
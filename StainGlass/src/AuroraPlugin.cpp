@@ -100,4 +100,6 @@ void getPluginFrame(Frame_t* frames, int* nFrames, int* sleepTime){
  */
 void pluginCleanup(){
 	//do deallocation here
+	delete [] frameColors;
+	frameColors = NULL;
 }
@@ -54,6 +54,7 @@ extern "C" {
 #define MAX_SOURCES 9   // maxiumum sources
 #define ADJACENT_PANEL_DISTANCE 86.599995   // hard coded distance between adjacent panels; this ideally should be autodetected
 #define TRANSITION_TIME 1  // the transition time to send to panels; set to 100ms currently
+#define LOG_LAYOUT false // print every palette colour and panel position on start-up
 #define MINIMUM_INTENSITY 0.2  // the minimum intensity of a source
 #define TRIGGER_THRESHOLD 0.5 // used to calculate whether to add a source
 //Light source consts
@@ -122,17 +123,21 @@ void initPlugin() {
         nColors = MAX_PALETTE_nColors;
     }
 
-    for (int i = 0; i < nColors; i++) {
-        PRINTLOG("   %d %d %d\n", palettenColors[i].R, palettenColors[i].G, palettenColors[i].B);
+    if(LOG_LAYOUT) {
+        for (int i = 0; i < nColors; i++) {
+            PRINTLOG("   %d %d %d\n", palettenColors[i].R, palettenColors[i].G, palettenColors[i].B);
+        }
     }
 
     layoutData = getLayoutData(); // grab the layout data and store a pointer to it for later use
 
 
-    PRINTLOG("The layout has %d panels:\n", layoutData->nPanels);
-    for (int i = 0; i < layoutData->nPanels; i++) {
-        PRINTLOG("   Id: %d   X, Y: %lf, %lf\n", layoutData->panels[i].panelId,
-               layoutData->panels[i].shape->getCentroid().x, layoutData->panels[i].shape->getCentroid().y);
+    PRINTLOG("The layout has %d panels\n", layoutData->nPanels);
+    if(LOG_LAYOUT) {
+        for (int i = 0; i < layoutData->nPanels; i++) {
+            PRINTLOG("   Id: %d   X, Y: %lf, %lf\n", layoutData->panels[i].panelId,
+                   layoutData->panels[i].shape->getCentroid().x, layoutData->panels[i].shape->getCentroid().y);
+        }
     }
     frameColors = new RGB_t[layoutData->nPanels];
   	for(int i =0; i < layoutData->nPanels; i++) {
@@ -365,5 +370,7 @@ void getPluginFrame(Frame_t* frames, int* nFrames, int* sleepTime) {
  * Do all deallocation for memory allocated in initplugin here
  */
 void pluginCleanup() {
-    // do deallocation here, but there is nothing to deallocate
+    delete [] frameColors;
+    frameColors = NULL;
+    nSources = 0;
 }